@@ -13,3 +13,7 @@
 #define CONFIG_QCOM_MDSS_PLL 1
 #define CONFIG_MSM_SDE_ROTATOR 1
 #define CONFIG_MSM_SDE_ROTATOR_EVTLOG_DEBUG 1
+
+#ifdef CONFIG_KUNIT
+#define CONFIG_DRM_MSM_SDE_KUNIT_TEST 1
+#endif
@@ -15,3 +15,7 @@
 #define CONFIG_QCOM_MDSS_PLL 1
 #define CONFIG_DRM_SDE_RSC 1
 #define CONFIG_GKI_DISPLAY 1
+
+#ifdef CONFIG_KUNIT
+#define CONFIG_DRM_MSM_SDE_KUNIT_TEST 1
+#endif
@@ -19,3 +19,7 @@
 #define CONFIG_DRM_SDE_RSC 1
 #define CONFIG_DRM_MSM_DP_MST 1
 #define CONFIG_DRM_MSM_DP_USBPD_LEGACY 1
+
+#ifdef CONFIG_KUNIT
+#define CONFIG_DRM_MSM_SDE_KUNIT_TEST 1
+#endif
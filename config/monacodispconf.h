@@ -10,3 +10,7 @@
 #define CONFIG_DSI_PARSER 1
 #define CONFIG_DRM_MSM_REGISTER_LOGGING 1
 #define CONFIG_QCOM_MDSS_PLL 1
+
+#ifdef CONFIG_KUNIT
+#define CONFIG_DRM_MSM_SDE_KUNIT_TEST 1
+#endif
@@ -326,8 +326,13 @@ static int dsi_ctrl_debugfs_init(struct dsi_ctrl *dsi_ctrl,
 		goto error_remove_dir;
 	}
 
+	debugfs_create_u32("cmd_batch_size", 0600, dir,
+			&dsi_ctrl->cmd_batch_size);
+
 	dsi_ctrl->debugfs_root = dir;
 
+	return 0;
+
 error_remove_dir:
 	debugfs_remove(dir);
 error:
@@ -1090,39 +1095,56 @@ error:
 	return rc;
 }
 
-static int dsi_ctrl_copy_and_pad_cmd(struct dsi_ctrl *dsi_ctrl,
-				     const struct mipi_dsi_packet *packet,
-				     u8 **buffer,
-				     u32 *size)
+/**
+ * dsi_ctrl_cmd_batch_size() - bytes of embedded commands to batch before
+ *	the batch is kicked off
+ * @dsi_ctrl:	DSI controller handle.
+ *
+ * Leaves room for one more embedded mode command behind the batch, so
+ * the command that crosses the limit still fits the command buffer.
+ */
+static u32 dsi_ctrl_cmd_batch_size(struct dsi_ctrl *dsi_ctrl)
 {
-	int rc = 0;
-	u8 *buf = NULL;
-	u32 len, i;
-	u8 cmd_type = 0;
+	u32 max_size = dsi_ctrl->cmd_buffer_size -
+			DSI_EMBEDDED_MODE_DMA_MAX_SIZE_BYTES;
 
-	len = packet->size;
-	len += 0x3; len &= ~0x03; /* Align to 32 bits */
+	if (!dsi_ctrl->cmd_batch_size)
+		return max_size;
 
-	buf = devm_kzalloc(&dsi_ctrl->pdev->dev, len * sizeof(u8), GFP_KERNEL);
-	if (!buf)
-		return -ENOMEM;
+	return min_t(u32, dsi_ctrl->cmd_batch_size, max_size);
+}
 
-	for (i = 0; i < len; i++) {
-		if (i >= packet->size)
-			buf[i] = 0xFF;
-		else if (i < sizeof(packet->header))
-			buf[i] = packet->header[i];
-		else
-			buf[i] = packet->payload[i - sizeof(packet->header)];
-	}
+/**
+ * dsi_ctrl_pack_cmd() - pack a dsi packet into its dma layout
+ * @packet:	Packet to pack.
+ * @buf:	Destination, at least ALIGN(packet->size, 4) bytes long.
+ *
+ * Writes the byte swapped header, the payload and the 0xFF padding to
+ * 32 bits straight into @buf, which is either the command dma buffer or
+ * the fifo staging buffer, so no intermediate copy is needed.
+ *
+ * Return: number of bytes written.
+ */
+static u32 dsi_ctrl_pack_cmd(const struct mipi_dsi_packet *packet, u8 *buf)
+{
+	u32 len, hdr_len = sizeof(packet->header);
+	u8 cmd_type = 0;
 
-	if (packet->payload_length > 0)
-		buf[3] |= BIT(6);
+	len = ALIGN(packet->size, 4);
 
 	/* Swap BYTE order in the command buffer for MSM */
 	buf[0] = packet->header[1];
 	buf[1] = packet->header[2];
 	buf[2] = packet->header[0];
+	buf[3] = packet->header[3];
+
+	if (packet->payload_length > 0) {
+		memcpy(buf + hdr_len, packet->payload, packet->payload_length);
+		buf[3] |= BIT(6);
+	}
+
+	if (len > packet->size)
+		memset(buf + packet->size, 0xFF, len - packet->size);
 
 	/* send embedded BTA for read commands */
 	cmd_type = buf[2] & 0x3f;
@@ -1132,10 +1154,7 @@ static int dsi_ctrl_copy_and_pad_cmd(struct dsi_ctrl *dsi_ctrl,
 			(cmd_type == MIPI_DSI_GENERIC_READ_REQUEST_2_PARAM))
 		buf[3] |= BIT(5);
 
-	*buffer = buf;
-	*size = len;
-
-	return rc;
+	return len;
 }
 
 int dsi_ctrl_wait_for_cmd_mode_mdp_idle(struct dsi_ctrl *dsi_ctrl)
@@ -1252,15 +1271,18 @@ int dsi_message_validate_tx_mode(struct dsi_ctrl *dsi_ctrl,
 			DSI_CTRL_ERR(dsi_ctrl, " Cannot transfer command,ops not defined\n");
 			return -ENOTSUPP;
 		}
-		if ((cmd_len + 4) > SZ_4K) {
-			DSI_CTRL_ERR(dsi_ctrl, "Cannot transfer,size is greater than 4096\n");
+		if ((cmd_len + 4) > dsi_ctrl->cmd_buffer_size) {
+			DSI_CTRL_ERR(dsi_ctrl, "Cannot transfer,size is greater than %u\n",
+					dsi_ctrl->cmd_buffer_size);
 			return -ENOTSUPP;
 		}
 	}
 
 	if (*flags & DSI_CTRL_CMD_FETCH_MEMORY) {
-		if ((dsi_ctrl->cmd_len + cmd_len + 4) > SZ_4K) {
-			DSI_CTRL_ERR(dsi_ctrl, "Cannot transfer,size is greater than 4096\n");
+		if ((dsi_ctrl->cmd_len + cmd_len + 4) >
+				dsi_ctrl->cmd_buffer_size) {
+			DSI_CTRL_ERR(dsi_ctrl, "Cannot transfer,size is greater than %u\n",
+					dsi_ctrl->cmd_buffer_size);
 			return -ENOTSUPP;
 		}
 	}
@@ -1521,6 +1543,44 @@ static void dsi_ctrl_clear_slave_dma_status(struct dsi_ctrl *dsi_ctrl, u32 flags
 	}
 }
 
+/**
+ * dsi_ctrl_flush_cmd_batch() - kick off the embedded commands batched so far
+ * @dsi_ctrl:	DSI controller handle.
+ * @tx_len:	Length of the message that doesn't fit behind the batch.
+ *
+ * Marks the last batched command as the last one and sends the batch on
+ * its own, with the modifiers it was batched with, so the next message
+ * gets the whole command buffer.
+ */
+static void dsi_ctrl_flush_cmd_batch(struct dsi_ctrl *dsi_ctrl, size_t tx_len)
+{
+	struct dsi_ctrl_cmd_dma_fifo_info cmd = {0};
+	struct dsi_ctrl_cmd_dma_info cmd_mem = {0};
+	struct mipi_dsi_msg msg = {0};
+	u8 *buffer = (u8 *)dsi_ctrl->vaddr + dsi_ctrl->cmd_last_offset;
+	u32 flags = dsi_ctrl->cmd_last_flags;
+
+	SDE_EVT32(dsi_ctrl->cell_index, SDE_EVTLOG_FUNC_CASE3,
+			dsi_ctrl->cmd_len, tx_len);
+
+	if (dsi_ctrl->dma_wait_queued)
+		dsi_ctrl_flush_cmd_dma_queue(dsi_ctrl);
+
+	msm_gem_sync(dsi_ctrl->tx_cmd_buf);
+	buffer[3] |= BIT(7);
+
+	msg.flags = dsi_ctrl->cmd_last_msg_flags | MIPI_DSI_MSG_LASTCOMMAND;
+	cmd_mem.offset = dsi_ctrl->cmd_buffer_iova;
+	cmd_mem.use_lpm = (msg.flags & MIPI_DSI_MSG_USE_LPM) ? true : false;
+	cmd_mem.length = dsi_ctrl->cmd_len;
+	dsi_ctrl->cmd_len = 0;
+
+	/* the buffer is reused right away, so wait for the transfer */
+	flags &= ~DSI_CTRL_CMD_ASYNC_WAIT;
+	dsi_kickoff_msg_tx(dsi_ctrl, &msg, &cmd, &cmd_mem,
+			flags | DSI_CTRL_CMD_LAST_COMMAND);
+}
+
 static int dsi_message_tx(struct dsi_ctrl *dsi_ctrl,
 			  const struct mipi_dsi_msg *msg,
 			  u32 *flags)
@@ -1529,14 +1589,27 @@ static int dsi_message_tx(struct dsi_ctrl *dsi_ctrl,
 	struct mipi_dsi_packet packet;
 	struct dsi_ctrl_cmd_dma_fifo_info cmd;
 	struct dsi_ctrl_cmd_dma_info cmd_mem;
+	u32 fifo_buf[DSI_CTRL_MAX_CMD_FIFO_STORE_SIZE / sizeof(u32)];
 	u32 length = 0;
 	u8 *buffer = NULL;
-	u32 cnt = 0;
-	u8 *cmdbuf;
 
 	/* Select the tx mode to transfer the command */
 	dsi_message_setup_tx_mode(dsi_ctrl, msg->tx_len, flags);
 
+	/*
+	 * Non-embedded commands are copied to the start of the buffer and
+	 * long ones may not fit behind the batch, send the batch first.
+	 * Broadcast and deferred trigger batches are kicked off by the
+	 * caller and can't be split.
+	 */
+	if (dsi_ctrl->cmd_len && (*flags & DSI_CTRL_CMD_FETCH_MEMORY) &&
+			!((*flags | dsi_ctrl->cmd_last_flags) &
+			(DSI_CTRL_CMD_BROADCAST | DSI_CTRL_CMD_DEFER_TRIGGER)) &&
+			((*flags & DSI_CTRL_CMD_NON_EMBEDDED_MODE) ||
+			(dsi_ctrl->cmd_len + msg->tx_len + 4) >
+			dsi_ctrl->cmd_buffer_size))
+		dsi_ctrl_flush_cmd_batch(dsi_ctrl, msg->tx_len);
+
 	/* Validate the mode before sending the command */
 	rc = dsi_message_validate_tx_mode(dsi_ctrl, msg->tx_len, flags);
 	if (rc) {
@@ -1583,14 +1656,7 @@ static int dsi_message_tx(struct dsi_ctrl *dsi_ctrl,
 		goto error;
 	}
 
-	rc = dsi_ctrl_copy_and_pad_cmd(dsi_ctrl,
-			&packet,
-			&buffer,
-			&length);
-	if (rc) {
-		DSI_CTRL_ERR(dsi_ctrl, "failed to copy message, rc=%d\n", rc);
-		goto error;
-	}
+	length = ALIGN(packet.size, 4);
 
 	/*
 	 * In case of broadcast CMD length cannot be greater than 512 bytes
@@ -1605,8 +1671,42 @@ static int dsi_message_tx(struct dsi_ctrl *dsi_ctrl,
 			SDE_EVT32(dsi_ctrl->cell_index, SDE_EVTLOG_FUNC_CASE1,
 					flags);
 		}
+	} else if ((*flags & DSI_CTRL_CMD_FETCH_MEMORY) &&
+			!(*flags & DSI_CTRL_CMD_DEFER_TRIGGER)) {
+		/*
+		 * Flush the batch with this command once it grows past the
+		 * batch size, instead of failing the transfer when a long
+		 * sequence doesn't fit the command buffer. Deferred trigger
+		 * batches are kicked off by the caller and can't be split.
+		 */
+		if ((dsi_ctrl->cmd_len + length) >
+				dsi_ctrl_cmd_batch_size(dsi_ctrl)) {
+			*flags |= DSI_CTRL_CMD_LAST_COMMAND;
+			SDE_EVT32(dsi_ctrl->cell_index, SDE_EVTLOG_FUNC_CASE2,
+					dsi_ctrl->cmd_len, length);
+		}
 	}
 
+	/*
+	 * Embedded mode commands are packed in place behind the ones
+	 * already batched in the dma buffer, everything else is staged
+	 * for the fifo which is bounded by the tx mode validation above.
+	 */
+	if (*flags & DSI_CTRL_CMD_FETCH_MEMORY) {
+		msm_gem_sync(dsi_ctrl->tx_cmd_buf);
+		buffer = (u8 *)dsi_ctrl->vaddr + dsi_ctrl->cmd_len;
+	} else {
+		if (length > sizeof(fifo_buf)) {
+			DSI_CTRL_ERR(dsi_ctrl, "cmd size %u exceeds fifo\n",
+					length);
+			rc = -ENOTSUPP;
+			goto error;
+		}
+		buffer = (u8 *)fifo_buf;
+	}
+
+	dsi_ctrl_pack_cmd(&packet, buffer);
+
 	if ((msg->flags & MIPI_DSI_MSG_LASTCOMMAND) ||
 			(*flags & DSI_CTRL_CMD_LAST_COMMAND))
 		buffer[3] |= BIT(7);//set the last cmd bit in header.
@@ -1621,12 +1721,9 @@ static int dsi_message_tx(struct dsi_ctrl *dsi_ctrl,
 		cmd_mem.use_lpm = (msg->flags & MIPI_DSI_MSG_USE_LPM) ?
 			true : false;
 
-		cmdbuf = (u8 *)(dsi_ctrl->vaddr);
-
-		msm_gem_sync(dsi_ctrl->tx_cmd_buf);
-		for (cnt = 0; cnt < length; cnt++)
-			cmdbuf[dsi_ctrl->cmd_len + cnt] = buffer[cnt];
-
+		dsi_ctrl->cmd_last_offset = dsi_ctrl->cmd_len;
+		dsi_ctrl->cmd_last_flags = *flags;
+		dsi_ctrl->cmd_last_msg_flags = msg->flags;
 		dsi_ctrl->cmd_len += length;
 
 		if (!(msg->flags & MIPI_DSI_MSG_LASTCOMMAND) &&
@@ -1651,8 +1748,6 @@ static int dsi_message_tx(struct dsi_ctrl *dsi_ctrl,
 kickoff:
 	dsi_kickoff_msg_tx(dsi_ctrl, msg, &cmd, &cmd_mem, *flags);
 error:
-	if (buffer)
-		devm_kfree(&dsi_ctrl->pdev->dev, buffer);
 	return rc;
 }
 
@@ -1994,7 +2089,7 @@ int dsi_ctrl_buffer_init(struct dsi_ctrl *dsi_ctrl)
 	}
 
 	dsi_ctrl->tx_cmd_buf = msm_gem_new(dsi_ctrl->drm_dev,
-					   SZ_4K,
+					   DSI_CTRL_CMD_BUFFER_SIZE,
 					   MSM_BO_UNCACHED);
 
 	if (IS_ERR(dsi_ctrl->tx_cmd_buf)) {
@@ -2004,7 +2099,7 @@ int dsi_ctrl_buffer_init(struct dsi_ctrl *dsi_ctrl)
 		goto error;
 	}
 
-	dsi_ctrl->cmd_buffer_size = SZ_4K;
+	dsi_ctrl->cmd_buffer_size = DSI_CTRL_CMD_BUFFER_SIZE;
 
 	rc = msm_gem_get_iova(dsi_ctrl->tx_cmd_buf, aspace, &iova);
 	if (rc) {
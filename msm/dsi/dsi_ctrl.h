@@ -53,6 +53,9 @@
 /* max size supported for dsi cmd transfer using TPG */
 #define DSI_CTRL_MAX_CMD_FIFO_STORE_SIZE 64
 
+/* size of the command dma buffer, batched commands are flushed before it */
+#define DSI_CTRL_CMD_BUFFER_SIZE SZ_16K
+
 /*Default tearcheck window size as programmed by MDP*/
 #define TEARCHECK_WINDOW_SIZE	5
 
@@ -210,6 +213,12 @@ struct dsi_ctrl_interrupts {
  * @tx_cmd_buf:          Tx command buffer.
  * @cmd_buffer_iova:     cmd buffer mapped address.
  * @cmd_buffer_size:     Size of command buffer.
+ * @cmd_batch_size:      Max bytes of embedded commands batched into one dma
+ *                       transfer, 0 to use as much of the buffer as possible.
+ * @cmd_last_offset:     Offset of the last command batched in the cmd buffer.
+ * @cmd_last_flags:      Modifiers of the last command batched in cmd buffer.
+ * @cmd_last_msg_flags:  Message flags of the last command batched in the cmd
+ *                       buffer.
  * @vaddr:               CPU virtual address of cmd buffer.
  * @secure_mode:         Indicates if secure-session is in progress
  * @esd_check_underway:  Indicates if esd status check is in progress
@@ -278,8 +287,12 @@ struct dsi_ctrl {
 	/* Command tx and rx */
 	struct drm_gem_object *tx_cmd_buf;
 	u32 cmd_buffer_size;
+	u32 cmd_batch_size;
 	u32 cmd_buffer_iova;
 	u32 cmd_len;
+	u32 cmd_last_offset;
+	u32 cmd_last_flags;
+	u16 cmd_last_msg_flags;
 	void *vaddr;
 	bool secure_mode;
 	bool esd_check_underway;
@@ -605,9 +605,14 @@ struct dsi_host_config {
  * @roi_caps:		  Panel ROI capabilities
  * @widebus_support       48 bit wide data bus is supported by hw
  * @allowed_mode_switch: BIT mask to mark allowed mode switches
+ * @cmd_sets_pending:     Command sets are not parsed yet, they are parsed
+ *                        from timing node @timing_node_idx on first use
+ * @timing_node_idx:      Index of the timing node the mode was parsed from
  */
 struct dsi_display_mode_priv_info {
 	struct dsi_panel_cmd_set cmd_sets[DSI_CMD_SET_MAX];
+	bool cmd_sets_pending;
+	u32 timing_node_idx;
 
 	u32 *phy_timing_val;
 	u32 phy_timing_len;
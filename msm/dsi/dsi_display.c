@@ -507,7 +507,7 @@ static int dsi_host_alloc_cmd_tx_buffer(struct dsi_display *display)
 	struct dsi_display_ctrl *display_ctrl;
 
 	display->tx_cmd_buf = msm_gem_new(display->drm_dev,
-			SZ_4K,
+			DSI_CTRL_CMD_BUFFER_SIZE,
 			MSM_BO_UNCACHED);
 
 	if ((display->tx_cmd_buf) == NULL) {
@@ -516,7 +516,7 @@ static int dsi_host_alloc_cmd_tx_buffer(struct dsi_display *display)
 		goto error;
 	}
 
-	display->cmd_buffer_size = SZ_4K;
+	display->cmd_buffer_size = DSI_CTRL_CMD_BUFFER_SIZE;
 
 	display->aspace = msm_gem_smmu_address_space_get(
 			display->drm_dev, MSM_SMMU_DOMAIN_UNSECURE);
@@ -556,7 +556,7 @@ static int dsi_host_alloc_cmd_tx_buffer(struct dsi_display *display)
 
 	display_for_each_ctrl(cnt, display) {
 		display_ctrl = &display->ctrl[cnt];
-		display_ctrl->ctrl->cmd_buffer_size = SZ_4K;
+		display_ctrl->ctrl->cmd_buffer_size = display->cmd_buffer_size;
 		display_ctrl->ctrl->cmd_buffer_iova =
 					display->cmd_buffer_iova;
 		display_ctrl->ctrl->vaddr = display->vaddr;
@@ -5813,6 +5813,15 @@ static int dsi_display_bind(struct device *dev,
 					display->name, rc);
 			goto error;
 		}
+
+		/* make later dynamic clock switches a cache lookup */
+		if (display->panel->dyn_clk_caps.dyn_clk_support &&
+				dsi_phy_cache_phy_timings(display_ctrl->phy,
+				&display->panel->host_config,
+				display->panel->dyn_clk_caps.bit_clk_list,
+				display->panel->dyn_clk_caps.bit_clk_list_len))
+			DSI_WARN("[%s] failed to precompute phy timings\n",
+					display->name);
 	}
 
 	/* register te irq handler */
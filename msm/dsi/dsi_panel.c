@@ -412,6 +412,9 @@ static int dsi_panel_power_off(struct dsi_panel *panel)
 
 	return rc;
 }
+static int dsi_panel_parse_mode_cmd_sets(struct dsi_panel *panel,
+		struct dsi_display_mode_priv_info *priv_info);
+
 static int dsi_panel_tx_cmd_set(struct dsi_panel *panel,
 				enum dsi_cmd_set_type type)
 {
@@ -428,6 +431,10 @@ static int dsi_panel_tx_cmd_set(struct dsi_panel *panel,
 
 	mode = panel->cur_mode;
 
+	rc = dsi_panel_parse_mode_cmd_sets(panel, mode->priv_info);
+	if (rc)
+		goto error;
+
 	cmds = mode->priv_info->cmd_sets[type].cmds;
 	count = mode->priv_info->cmd_sets[type].count;
 	state = mode->priv_info->cmd_sets[type].state;
@@ -1974,6 +1981,53 @@ static int dsi_panel_parse_cmd_sets(
 	return rc;
 }
 
+/**
+ * dsi_panel_parse_mode_cmd_sets() - parse the command sets of a mode on
+ *	first use, modes that are never set don't allocate them. Parsed sets
+ *	stay cached until dsi_panel_put_mode() frees the mode.
+ * @panel:	Display panel, panel_lock must be held.
+ * @priv_info:	Private info of the mode.
+ */
+static int dsi_panel_parse_mode_cmd_sets(struct dsi_panel *panel,
+		struct dsi_display_mode_priv_info *priv_info)
+{
+	struct dsi_parser_utils *utils = &panel->utils;
+	struct device_node *timings_np, *child_np;
+	void *utils_data = utils->data;
+	u32 child_idx = 0;
+	int rc = -EINVAL;
+
+	if (!priv_info || !priv_info->cmd_sets_pending)
+		return 0;
+
+	timings_np = utils->get_child_by_name(utils->data,
+			"qcom,mdss-dsi-display-timings");
+	if (!timings_np) {
+		DSI_ERR("no display timing nodes defined\n");
+		return rc;
+	}
+
+	dsi_for_each_child_node(timings_np, child_np) {
+		if (priv_info->timing_node_idx != child_idx++)
+			continue;
+
+		utils->data = child_np;
+		rc = dsi_panel_parse_cmd_sets(priv_info, utils);
+		utils->data = utils_data;
+		break;
+	}
+
+	if (rc) {
+		DSI_ERR("[%s] failed to parse command sets of timing %d, rc=%d\n",
+				panel->name, priv_info->timing_node_idx, rc);
+		return rc;
+	}
+
+	priv_info->cmd_sets_pending = false;
+
+	return 0;
+}
+
 static int dsi_panel_parse_reset_sequence(struct dsi_panel *panel)
 {
 	int rc = 0;
@@ -3416,6 +3470,12 @@ static void dsi_panel_update_util(struct dsi_panel *panel,
 {
 	struct dsi_parser_utils *utils = &panel->utils;
 
+	/*
+	 * The parser tree can be freed by a reload through debugfs, command
+	 * sets are parsed on first use only from the device tree.
+	 */
+	panel->lazy_cmd_sets = !parser_node;
+
 	if (parser_node) {
 		*utils = *dsi_parser_get_parser_utils();
 		utils->data = parser_node;
@@ -4083,10 +4143,17 @@ int dsi_panel_get_mode(struct dsi_panel *panel,
 			goto parse_fail;
 		}
 
-		rc = dsi_panel_parse_cmd_sets(prv_info, utils);
-		if (rc) {
-			DSI_ERR("failed to parse command sets, rc=%d\n", rc);
-			goto parse_fail;
+		if (panel->lazy_cmd_sets) {
+			/* command sets are parsed when the mode is first used */
+			prv_info->cmd_sets_pending = true;
+			prv_info->timing_node_idx = index;
+		} else {
+			rc = dsi_panel_parse_cmd_sets(prv_info, utils);
+			if (rc) {
+				DSI_ERR("failed to parse command sets, rc=%d\n",
+						rc);
+				goto parse_fail;
+			}
 		}
 
 		rc = dsi_panel_parse_jitter_config(mode, utils);
@@ -4216,6 +4283,10 @@ int dsi_panel_update_pps(struct dsi_panel *panel)
 
 	priv_info = panel->cur_mode->priv_info;
 
+	rc = dsi_panel_parse_mode_cmd_sets(panel, priv_info);
+	if (rc)
+		goto error;
+
 	set = &priv_info->cmd_sets[DSI_CMD_SET_PPS];
 
 	if (priv_info->dsc_enabled)
@@ -4505,18 +4576,25 @@ int dsi_panel_send_roi_dcs(struct dsi_panel *panel, int ctrl_idx,
 	priv_info = panel->cur_mode->priv_info;
 	set = &priv_info->cmd_sets[DSI_CMD_SET_ROI];
 
+	mutex_lock(&panel->panel_lock);
+
+	rc = dsi_panel_parse_mode_cmd_sets(panel, priv_info);
+	if (rc) {
+		mutex_unlock(&panel->panel_lock);
+		return rc;
+	}
+
 	rc = dsi_panel_roi_prepare_dcs_cmds(set, roi, ctrl_idx, true);
 	if (rc) {
 		DSI_ERR("[%s] failed to prepare DSI_CMD_SET_ROI cmds, rc=%d\n",
 				panel->name, rc);
+		mutex_unlock(&panel->panel_lock);
 		return rc;
 	}
 	DSI_DEBUG("[%s] send roi x %d y %d w %d h %d\n", panel->name,
 			roi->x, roi->y, roi->w, roi->h);
 	SDE_EVT32(roi->x, roi->y, roi->w, roi->h);
 
-	mutex_lock(&panel->panel_lock);
-
 	rc = dsi_panel_tx_cmd_set(panel, DSI_CMD_SET_ROI);
 	if (rc)
 		DSI_ERR("[%s] failed to send DSI_CMD_SET_ROI cmds, rc=%d\n",
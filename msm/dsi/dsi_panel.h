@@ -236,6 +236,7 @@ struct dsi_panel {
 	struct drm_panel_esd_config esd_config;
 
 	struct dsi_parser_utils utils;
+	bool lazy_cmd_sets;
 
 	bool lp11_init;
 	bool ulps_feature_enabled;
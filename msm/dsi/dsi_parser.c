@@ -10,6 +10,8 @@
 #include <linux/debugfs.h>
 #include <linux/uaccess.h>
 #include <linux/device.h>
+#include <linux/jhash.h>
+#include <linux/log2.h>
 
 #include "dsi_parser.h"
 #include "dsi_defs.h"
@@ -31,17 +33,27 @@ struct dsi_parser_prop {
 	char **items;
 	enum dsi_parser_prop_type type;
 	int len;
+	u32 hash;
 };
 
 struct dsi_parser_node {
 	char *name;
 	char *data;
+	u32 hash;
 
 	struct dsi_parser_prop *prop;
 	int prop_count;
 
+	/* open addressed index into prop, by name hash, -1 for empty slots */
+	int *prop_table;
+	u32 prop_table_mask;
+
 	struct dsi_parser_node *child[DSI_PARSER_MAX_NODES];
 	int children_count;
+
+	/* open addressed index into child, by name hash, -1 for empty slots */
+	int *child_table;
+	u32 child_table_mask;
 };
 
 struct dsi_parser {
@@ -422,6 +434,78 @@ static void dsi_parser_count_properties(struct dsi_parser_node *node)
 	}
 }
 
+static u32 dsi_parser_hash(const char *name)
+{
+	return jhash(name, strlen(name), 0);
+}
+
+static void dsi_parser_index_properties(struct device *dev,
+		struct dsi_parser_node *node)
+{
+	u32 size, slot;
+	int i;
+
+	/* keep the table at most half full so probe chains stay short */
+	size = roundup_pow_of_two(node->prop_count * 2);
+
+	node->prop_table = devm_kmalloc_array(dev, size,
+			sizeof(*node->prop_table), GFP_KERNEL);
+	if (!node->prop_table)
+		return;
+
+	memset(node->prop_table, 0xff, size * sizeof(*node->prop_table));
+	node->prop_table_mask = size - 1;
+
+	/* insert in order so duplicate names resolve to the first one */
+	for (i = 0; i < node->prop_count; i++) {
+		struct dsi_parser_prop *prop = &node->prop[i];
+
+		if (!prop->name)
+			continue;
+
+		prop->hash = dsi_parser_hash(prop->name);
+
+		slot = prop->hash & node->prop_table_mask;
+		while (node->prop_table[slot] >= 0)
+			slot = (slot + 1) & node->prop_table_mask;
+
+		node->prop_table[slot] = i;
+	}
+}
+
+static void dsi_parser_index_children(struct device *dev,
+		struct dsi_parser_node *node)
+{
+	u32 size, slot;
+	int i;
+
+	size = roundup_pow_of_two(node->children_count * 2);
+
+	node->child_table = devm_kmalloc_array(dev, size,
+			sizeof(*node->child_table), GFP_KERNEL);
+	if (!node->child_table)
+		return;
+
+	memset(node->child_table, 0xff, size * sizeof(*node->child_table));
+	node->child_table_mask = size - 1;
+
+	/* insert in order so duplicate names resolve to the first one */
+	for (i = 0; i < node->children_count; i++) {
+		struct dsi_parser_node *child = node->child[i];
+
+		if (!child || !child->name)
+			continue;
+
+		child->hash = dsi_parser_hash(child->name);
+
+		slot = child->hash & node->child_table_mask;
+		while (node->child_table[slot] >= 0)
+			slot = (slot + 1) & node->child_table_mask;
+
+		node->child_table[slot] = i;
+	}
+}
+
 static void dsi_parser_get_properties(struct device *dev,
 		struct dsi_parser_node *node)
 {
@@ -430,6 +514,9 @@ static void dsi_parser_get_properties(struct device *dev,
 	if (!node)
 		return;
 
+	if (node->children_count)
+		dsi_parser_index_children(dev, node);
+
 	if (node->prop_count) {
 		int i = 0;
 		char *buf = node->data;
@@ -461,13 +548,15 @@ static void dsi_parser_get_properties(struct device *dev,
 				}
 			}
 		}
+
+		dsi_parser_index_properties(dev, node);
 	}
 
 	for (count = 0; count < node->children_count; count++)
 		dsi_parser_get_properties(dev, node->child[count]);
 }
 
-static struct dsi_parser_prop *dsi_parser_search_property(
+static struct dsi_parser_prop *dsi_parser_search_property_linear(
 			struct dsi_parser_node *node,
 			const char *name)
 {
@@ -482,6 +571,30 @@ static struct dsi_parser_prop *dsi_parser_search_property(
 	return NULL;
 }
 
+static struct dsi_parser_prop *dsi_parser_search_property(
+			struct dsi_parser_node *node,
+			const char *name)
+{
+	int i = 0;
+	struct dsi_parser_prop *prop = node->prop;
+	u32 hash, slot;
+
+	if (!node->prop_table)
+		return dsi_parser_search_property_linear(node, name);
+
+	hash = dsi_parser_hash(name);
+
+	for (slot = hash & node->prop_table_mask; node->prop_table[slot] >= 0;
+			slot = (slot + 1) & node->prop_table_mask) {
+		i = node->prop_table[slot];
+
+		if (prop[i].hash == hash && !strcmp(prop[i].name, name))
+			return &prop[i];
+	}
+
+	return NULL;
+}
+
 /* APIs for the clients */
 struct property *dsi_parser_find_property(const struct device_node *np,
 				  const char *name,
@@ -677,27 +790,54 @@ end:
 	return property;
 }
 
+static struct dsi_parser_node *dsi_parser_search_child_linear(
+			struct dsi_parser_node *node,
+			const char *name)
+{
+	int index = 0;
+
+	do {
+		struct dsi_parser_node *child_node = node->child[index++];
+
+		if (!child_node)
+			break;
+
+		if (!strcmp(child_node->name, name))
+			return child_node;
+	} while (index < node->children_count);
+
+	return NULL;
+}
+
 struct device_node *dsi_parser_get_child_by_name(const struct device_node *np,
 				const char *name)
 {
-	int index = 0;
 	struct dsi_parser_node *node = (struct dsi_parser_node *)np;
 	struct dsi_parser_node *matched_node = NULL;
+	struct dsi_parser_node *child_node;
+	u32 hash, slot;
 
 	if (!node || !node->children_count)
 		goto end;
 
-	do {
-		struct dsi_parser_node *child_node = node->child[index++];
+	if (!node->child_table) {
+		matched_node = dsi_parser_search_child_linear(node, name);
+		goto end;
+	}
 
-		if (!child_node)
-			goto end;
+	hash = dsi_parser_hash(name);
 
-		if (!strcmp(child_node->name, name)) {
+	for (slot = hash & node->child_table_mask;
+			node->child_table[slot] >= 0;
+			slot = (slot + 1) & node->child_table_mask) {
+		child_node = node->child[node->child_table[slot]];
+
+		if (child_node->hash == hash &&
+				!strcmp(child_node->name, name)) {
 			matched_node = child_node;
 			break;
 		}
-	} while (index < node->children_count);
+	}
 end:
 	DSI_DEBUG("%s: %s\n", name, matched_node ? "found" : "not found");
 
@@ -955,6 +1095,12 @@ static void dsi_parser_free_mem(struct device *dev,
 			devm_kfree(dev, prop->value);
 	}
 
+	if (node->prop_table)
+		devm_kfree(dev, node->prop_table);
+
+	if (node->child_table)
+		devm_kfree(dev, node->child_table);
+
 	if (node->prop)
 		devm_kfree(dev, node->prop);
 
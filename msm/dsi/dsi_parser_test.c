@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#include <kunit/test.h>
+#include <linux/device.h>
+#include <linux/ktime.h>
+#include <linux/sizes.h>
+#include <linux/slab.h>
+
+#include "dsi_parser.h"
+#include "sde_kunit.h"
+
+#define DSI_PARSER_TEST_PROPS		128
+#define DSI_PARSER_TEST_CHILDREN	16
+#define DSI_PARSER_TEST_ROUNDS		1000
+#define DSI_PARSER_TEST_NAME_LEN	32
+
+/**
+ * struct dsi_parser_test - parser of a node with many numbered properties
+ *	and child nodes
+ * @dev: device the parser allocates from
+ * @parser: parser handle
+ * @node: node holding the properties
+ * @names: names of the numbered properties
+ * @child_names: names of the numbered child nodes
+ */
+struct dsi_parser_test {
+	struct device *dev;
+	void *parser;
+	struct device_node *node;
+	char names[DSI_PARSER_TEST_PROPS][DSI_PARSER_TEST_NAME_LEN];
+	char child_names[DSI_PARSER_TEST_CHILDREN][DSI_PARSER_TEST_NAME_LEN];
+};
+
+/*
+ * The strcmp scan over the names in node order that the lookups used before
+ * the name index, returns the position of the first match or -1.
+ */
+static int dsi_parser_test_scan(const char (*names)[DSI_PARSER_TEST_NAME_LEN],
+		int count, const char *name)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		if (!strcmp(names[i], name))
+			return i;
+
+	return -1;
+}
+
+static void dsi_parser_test_exit(struct kunit *test)
+{
+	struct dsi_parser_test *ctx = test->priv;
+
+	dsi_parser_put(ctx->parser);
+	root_device_unregister(ctx->dev);
+}
+
+/*
+ * The node holds the numbered properties with their index as value, then
+ * a duplicate of the first one and a boolean property, then the numbered
+ * child nodes each holding its index.
+ */
+static int dsi_parser_test_init(struct kunit *test)
+{
+	struct dsi_parser_test *ctx;
+	size_t size = 0, len;
+	char *data;
+	int i;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	len = (DSI_PARSER_TEST_PROPS + DSI_PARSER_TEST_CHILDREN * 2) *
+			(DSI_PARSER_TEST_NAME_LEN + 16) + SZ_256;
+	data = kunit_kzalloc(test, len, GFP_KERNEL);
+	if (!data)
+		return -ENOMEM;
+
+	ctx->dev = root_device_register("dsi_parser_test");
+	if (IS_ERR(ctx->dev))
+		return PTR_ERR(ctx->dev);
+
+	ctx->parser = dsi_parser_get(ctx->dev);
+	if (IS_ERR_OR_NULL(ctx->parser)) {
+		root_device_unregister(ctx->dev);
+		return -ENOMEM;
+	}
+
+	size += scnprintf(data + size, len - size, "dsi_parser_test {\n");
+	for (i = 0; i < DSI_PARSER_TEST_PROPS; i++) {
+		snprintf(ctx->names[i], DSI_PARSER_TEST_NAME_LEN,
+				"qcom,mdss-dsi-test-prop-%d", i);
+		size += scnprintf(data + size, len - size, "  %s = <%d>;\n",
+				ctx->names[i], i);
+	}
+	size += scnprintf(data + size, len - size, "  %s = <%d>;\n",
+			ctx->names[0], DSI_PARSER_TEST_PROPS);
+	size += scnprintf(data + size, len - size,
+			"  qcom,mdss-dsi-test-bool;\n");
+	for (i = 0; i < DSI_PARSER_TEST_CHILDREN; i++) {
+		snprintf(ctx->child_names[i], DSI_PARSER_TEST_NAME_LEN,
+				"qcom,mdss-dsi-test-child-%d", i);
+		size += scnprintf(data + size, len - size,
+				"  %s {\n    qcom,mdss-dsi-test-index = <%d>;\n  };\n",
+				ctx->child_names[i], i);
+	}
+	size += scnprintf(data + size, len - size, "};\n");
+
+	/* the parser keeps a copy of the data, with its terminator */
+	ctx->node = dsi_parser_get_head_node(ctx->parser, data, size + 1);
+	if (!ctx->node) {
+		/* the parser memory is released along with the device */
+		root_device_unregister(ctx->dev);
+		return -EINVAL;
+	}
+
+	test->priv = ctx;
+
+	return 0;
+}
+
+static void dsi_parser_test_lookup(struct kunit *test)
+{
+	struct dsi_parser_test *ctx = test->priv;
+	struct device_node *child;
+	u32 val;
+	int i, len;
+
+	for (i = 0; i < DSI_PARSER_TEST_PROPS; i++) {
+		KUNIT_EXPECT_NOT_ERR_OR_NULL_MSG(test,
+			dsi_parser_find_property(ctx->node, ctx->names[i],
+				&len), "prop %s", ctx->names[i]);
+
+		/* the duplicate of the first property doesn't shadow it */
+		KUNIT_EXPECT_EQ(test, 0, dsi_parser_read_u32(ctx->node,
+				ctx->names[i], &val));
+		KUNIT_EXPECT_EQ(test, (u32)dsi_parser_test_scan(ctx->names,
+				DSI_PARSER_TEST_PROPS, ctx->names[i]), val);
+	}
+
+	for (i = 0; i < DSI_PARSER_TEST_CHILDREN; i++) {
+		child = dsi_parser_get_child_by_name(ctx->node,
+				ctx->child_names[i]);
+		KUNIT_ASSERT_NOT_ERR_OR_NULL_MSG(test, child, "child %s",
+				ctx->child_names[i]);
+
+		KUNIT_EXPECT_EQ(test, 0, dsi_parser_read_u32(child,
+				"qcom,mdss-dsi-test-index", &val));
+		KUNIT_EXPECT_EQ(test, (u32)i, val);
+	}
+
+	KUNIT_EXPECT_PTR_EQ(test, NULL, dsi_parser_get_child_by_name(ctx->node,
+			"qcom,mdss-dsi-test-child"));
+
+	KUNIT_EXPECT_TRUE(test, dsi_parser_read_bool(ctx->node,
+			"qcom,mdss-dsi-test-bool"));
+	KUNIT_EXPECT_FALSE(test, dsi_parser_read_bool(ctx->node,
+			"qcom,mdss-dsi-test-missing"));
+	KUNIT_EXPECT_PTR_EQ(test, NULL, dsi_parser_find_property(ctx->node,
+			"qcom,mdss-dsi-test-prop", &len));
+}
+
+/* times a lookup of every numbered property against the strcmp scan */
+static void dsi_parser_test_bench(struct kunit *test)
+{
+	struct dsi_parser_test *ctx = test->priv;
+	u64 start_ns, linear_ns, hash_ns;
+	int i, j, len;
+
+	start_ns = ktime_get_ns();
+	for (i = 0; i < DSI_PARSER_TEST_ROUNDS; i++)
+		for (j = 0; j < DSI_PARSER_TEST_PROPS; j++)
+			dsi_parser_test_scan(ctx->names,
+					DSI_PARSER_TEST_PROPS, ctx->names[j]);
+	linear_ns = ktime_get_ns() - start_ns;
+
+	start_ns = ktime_get_ns();
+	for (i = 0; i < DSI_PARSER_TEST_ROUNDS; i++)
+		for (j = 0; j < DSI_PARSER_TEST_PROPS; j++)
+			dsi_parser_find_property(ctx->node, ctx->names[j],
+					&len);
+	hash_ns = ktime_get_ns() - start_ns;
+
+	kunit_info(test, "ns per %d lookups: linear:%llu hash:%llu\n",
+			DSI_PARSER_TEST_PROPS,
+			div_u64(linear_ns, DSI_PARSER_TEST_ROUNDS),
+			div_u64(hash_ns, DSI_PARSER_TEST_ROUNDS));
+	KUNIT_EXPECT_LT(test, hash_ns, linear_ns);
+}
+
+static struct kunit_case dsi_parser_test_cases[] = {
+	KUNIT_CASE(dsi_parser_test_lookup),
+	KUNIT_CASE(dsi_parser_test_bench),
+	{}
+};
+
+struct kunit_suite dsi_parser_test_suite = {
+	.name = "dsi_parser",
+	.init = dsi_parser_test_init,
+	.exit = dsi_parser_test_exit,
+	.test_cases = dsi_parser_test_cases,
+};
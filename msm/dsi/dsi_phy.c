@@ -999,6 +999,49 @@ int dsi_phy_update_phy_timings(struct msm_dsi_phy *phy,
 	return rc;
 }
 
+int dsi_phy_cache_phy_timings(struct msm_dsi_phy *phy,
+			      struct dsi_host_common_cfg *host,
+			      u32 *bit_clk_list, u32 count)
+{
+	struct dsi_phy_per_lane_cfgs *timing;
+	struct dsi_mode_info mode;
+	int rc = 0;
+	u32 i;
+
+	if (!phy || !host || !bit_clk_list) {
+		DSI_PHY_ERR(phy, "invalid argument\n");
+		return -EINVAL;
+	}
+
+	if (phy->cfg.is_phy_timing_present ||
+			!phy->hw.ops.calculate_timing_params ||
+			!phy->hw.ops.timing_ops)
+		return 0;
+
+	/* scratch output, only the calculator's cache is of interest */
+	timing = kzalloc(sizeof(*timing), GFP_KERNEL);
+	if (!timing)
+		return -ENOMEM;
+
+	memset(&mode, 0, sizeof(mode));
+
+	mutex_lock(&phy->phy_lock);
+	for (i = 0; i < count; i++) {
+		mode.clk_rate_hz = bit_clk_list[i];
+		rc = phy->hw.ops.calculate_timing_params(&phy->hw, &mode,
+				host, timing, true);
+		if (rc) {
+			DSI_PHY_ERR(phy, "failed to calculate timings for %u, rc=%d\n",
+					bit_clk_list[i], rc);
+			break;
+		}
+	}
+	mutex_unlock(&phy->phy_lock);
+
+	kfree(timing);
+	return rc;
+}
+
 int dsi_phy_lane_reset(struct msm_dsi_phy *phy)
 {
 	int ret = 0;
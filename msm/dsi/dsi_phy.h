@@ -310,6 +310,21 @@ void dsi_phy_drv_register(void);
  */
 void dsi_phy_drv_unregister(void);
 
+/**
+ * dsi_phy_cache_phy_timings() - Calculate the phy timings of a list of bit
+ *				 clocks ahead of time, so switching to one of
+ *				 them later reuses the result
+ * @phy:		DSI PHY handle
+ * @host:		DSI Host common config
+ * @bit_clk_list:	Bit clock rates in Hz
+ * @count:		Number of entries in @bit_clk_list
+ *
+ * Return: error code.
+ */
+int dsi_phy_cache_phy_timings(struct msm_dsi_phy *phy,
+			      struct dsi_host_common_cfg *host,
+			      u32 *bit_clk_list, u32 count);
+
 /**
  * dsi_phy_update_phy_timings() - Update dsi phy timings
  * @phy:	DSI PHY handle
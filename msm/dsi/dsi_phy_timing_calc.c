@@ -8,6 +8,80 @@
 static const u32 bits_per_pixel[DSI_PIXEL_FORMAT_MAX] = {
 	16, 18, 18, 24, 3, 8, 12, 30 };
 
+#define DSI_PHY_TIMING_CACHE_SIZE 16
+
+/**
+ * struct phy_timing_cache_entry - calculated timings for one bit clock
+ * @bitclk_mbps:     Bit clock the timings were calculated for.
+ * @phy_type:        DPHY or CPHY.
+ * @desc:            Calculated timing parameters.
+ */
+struct phy_timing_cache_entry {
+	u32 bitclk_mbps;
+	u32 phy_type;
+	struct phy_timing_desc desc;
+};
+
+/**
+ * struct phy_timing_calc - per phy timing calculator state
+ * @ops:             Version specific calculation ops.
+ * @cache_lock:      Protects the cache.
+ * @cache:           Timings of the most recently calculated bit clocks.
+ * @cache_count:     Number of valid cache entries.
+ * @cache_next:      Entry to replace next once the cache is full.
+ */
+struct phy_timing_calc {
+	struct phy_timing_ops ops;
+	struct mutex cache_lock;
+	struct phy_timing_cache_entry cache[DSI_PHY_TIMING_CACHE_SIZE];
+	u32 cache_count;
+	u32 cache_next;
+};
+
+#define to_phy_timing_calc(x) container_of(x, struct phy_timing_calc, ops)
+
+static bool dsi_phy_timing_cache_get(struct phy_timing_calc *calc,
+		u32 bitclk_mbps, u32 phy_type, struct phy_timing_desc *desc)
+{
+	struct phy_timing_cache_entry *entry;
+	bool found = false;
+	u32 i;
+
+	mutex_lock(&calc->cache_lock);
+	for (i = 0; i < calc->cache_count; i++) {
+		entry = &calc->cache[i];
+		if (entry->bitclk_mbps == bitclk_mbps &&
+				entry->phy_type == phy_type) {
+			memcpy(desc, &entry->desc, sizeof(*desc));
+			found = true;
+			break;
+		}
+	}
+	mutex_unlock(&calc->cache_lock);
+
+	return found;
+}
+
+static void dsi_phy_timing_cache_put(struct phy_timing_calc *calc,
+		u32 bitclk_mbps, u32 phy_type, struct phy_timing_desc *desc)
+{
+	struct phy_timing_cache_entry *entry;
+
+	mutex_lock(&calc->cache_lock);
+	if (calc->cache_count < DSI_PHY_TIMING_CACHE_SIZE) {
+		entry = &calc->cache[calc->cache_count++];
+	} else {
+		entry = &calc->cache[calc->cache_next];
+		calc->cache_next = (calc->cache_next + 1) %
+				DSI_PHY_TIMING_CACHE_SIZE;
+	}
+
+	entry->bitclk_mbps = bitclk_mbps;
+	entry->phy_type = phy_type;
+	memcpy(&entry->desc, desc, sizeof(*desc));
+	mutex_unlock(&calc->cache_lock);
+}
+
 static int dsi_phy_cmn_validate_and_set(struct timing_entry *t,
 	char const *t_name)
 {
@@ -878,6 +952,7 @@ int dsi_phy_hw_calculate_timing_params(struct dsi_phy_hw *phy,
 	struct phy_timing_desc desc;
 	struct phy_clk_params clk_params = {0};
 	struct phy_timing_ops *ops = phy->ops.timing_ops;
+	struct phy_timing_calc *calc = to_phy_timing_calc(ops);
 
 	u32 phy_type = host->phy_type;
 
@@ -936,6 +1011,14 @@ int dsi_phy_hw_calculate_timing_params(struct dsi_phy_hw *phy,
 	       clk_params.bitclk_mbps, clk_params.tlpx_numer_ns,
 	       clk_params.treot_ns);
 
+	/* timings only depend on the bit clock, reuse earlier results */
+	if (dsi_phy_timing_cache_get(calc, clk_params.bitclk_mbps, phy_type,
+			&desc)) {
+		DSI_PHY_DBG(phy, "using cached timings for %d mbps\n",
+				clk_params.bitclk_mbps);
+		goto update;
+	}
+
 	if (phy_type == DSI_PHY_TYPE_CPHY)
 		rc = dsi_phy_cmn_calc_cphy_timing_params(phy, &clk_params,
 							&desc);
@@ -946,6 +1029,11 @@ int dsi_phy_hw_calculate_timing_params(struct dsi_phy_hw *phy,
 		goto error;
 	}
 
+	dsi_phy_timing_cache_put(calc, clk_params.bitclk_mbps, phy_type,
+			&desc);
+
+update:
+
 	if (ops->update_timing_params) {
 		ops->update_timing_params(timing, &desc, phy_type);
 	} else {
@@ -960,6 +1048,7 @@ error:
 int dsi_phy_timing_calc_init(struct dsi_phy_hw *phy,
 			enum dsi_phy_version version)
 {
+	struct phy_timing_calc *calc = NULL;
 	struct phy_timing_ops *ops = NULL;
 
 	if (version == DSI_PHY_VERSION_UNKNOWN ||
@@ -968,9 +1057,11 @@ int dsi_phy_timing_calc_init(struct dsi_phy_hw *phy,
 		return -ENOTSUPP;
 	}
 
-	ops = kzalloc(sizeof(struct phy_timing_ops), GFP_KERNEL);
-	if (!ops)
+	calc = kzalloc(sizeof(*calc), GFP_KERNEL);
+	if (!calc)
 		return -EINVAL;
+	mutex_init(&calc->cache_lock);
+	ops = &calc->ops;
 	phy->ops.timing_ops = ops;
 
 	switch (version) {
@@ -1028,7 +1119,8 @@ int dsi_phy_timing_calc_init(struct dsi_phy_hw *phy,
 	case DSI_PHY_VERSION_0_0_LPM:
 	case DSI_PHY_VERSION_1_0:
 	default:
-		kfree(ops);
+		phy->ops.timing_ops = NULL;
+		kfree(calc);
 		return -ENOTSUPP;
 	}
 
@@ -51,6 +51,7 @@
 #include "msm_mmu.h"
 #include "sde_wb.h"
 #include "sde_dbg.h"
+#include "sde_kunit.h"
 
 /*
  * MSM driver version:
@@ -2295,6 +2296,7 @@ static int __init msm_drm_register(void)
 	msm_edp_register();
 	msm_hdmi_register();
 	sde_wb_register();
+	sde_kunit_run();
 	return platform_driver_register(&msm_platform_driver);
 }
 
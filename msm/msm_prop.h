@@ -7,10 +7,14 @@
 #define _MSM_PROP_H_
 
 #include <linux/list.h>
+#include <linux/bitmap.h>
 #include "msm_drv.h"
 
 #define MSM_PROP_STATE_CACHE_SIZE	2
 
+/* upper bound of the property count of any drm object using msm_prop */
+#define MSM_PROP_MAX_COUNT		128
+
 /**
  * struct msm_property_data - opaque structure for tracking per
  *                            drm-object per property stuff
@@ -28,12 +32,10 @@ struct msm_property_data {
  *                             drm-object per property stuff
  * @value: Current property value for this drm object
  * @blob: Pointer to associated blob data, if available
- * @dirty_node: Linked list node to track if property is dirty or not
  */
 struct msm_property_value {
 	uint64_t value;
 	struct drm_property_blob *blob;
-	struct list_head dirty_node;
 };
 
 /**
@@ -78,13 +80,13 @@ struct msm_property_info {
  * struct msm_property_state - Structure for local property state information
  * @property_count: Total number of properties
  * @values: Pointer to array of msm_property_value objects
- * @dirty_list: List of all properties that have been 'atomic_set' but not
+ * @dirty_mask: Bitmap of all properties that have been 'atomic_set' but not
  *              yet cleared with 'msm_property_pop_dirty'
  */
 struct msm_property_state {
 	uint32_t property_count;
 	struct msm_property_value *values;
-	struct list_head dirty_list;
+	DECLARE_BITMAP(dirty_mask, MSM_PROP_MAX_COUNT);
 };
 
 /**
@@ -167,7 +169,7 @@ bool msm_property_get_is_active(struct msm_property_info *info)
  *			  the lock when finished.
  * @info: Pointer to property info container struct
  * @property_state: Pointer to property state container struct
- * Returns: Valid msm property index on success,
+ * Returns: Valid msm property index on success, lowest index first,
  *          -EAGAIN if no dirty properties are available
  *          Property indicies returned from this function are similar
  *          to those returned by the msm_property_index function.
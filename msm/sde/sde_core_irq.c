@@ -9,10 +9,30 @@
 #include <linux/irqdomain.h>
 #include <linux/irq.h>
 #include <linux/kthread.h>
+#include <linux/rculist.h>
 
 #include "sde_core_irq.h"
 #include "sde_power_handle.h"
 
+/**
+ * struct sde_irq_cb_node - registered callback as seen by the irq handler
+ * @list: node in the rcu protected callback list of an irq
+ * @rcu: frees the node once no handler can still walk it
+ * @cb: registered callback, only used to find the node again
+ * @func: handler of the callback at registration
+ * @arg: argument of the handler at registration
+ *
+ * Nodes are allocated on each registration and freed after a grace period,
+ * so a handler walking the list never sees a node being reused.
+ */
+struct sde_irq_cb_node {
+	struct list_head list;
+	struct rcu_head rcu;
+	struct sde_irq_callback *cb;
+	void (*func)(void *arg, int irq_idx);
+	void *arg;
+};
+
 /**
  * sde_core_irq_callback_handler - dispatch core interrupts
  * @arg:		private data of callback handler
@@ -22,16 +42,24 @@ static void sde_core_irq_callback_handler(void *arg, int irq_idx)
 {
 	struct sde_kms *sde_kms = arg;
 	struct sde_irq *irq_obj = &sde_kms->irq_obj;
-	struct sde_irq_callback *cb;
-	unsigned long irq_flags;
+	struct sde_irq_cb_node *node;
+	struct sde_irq_cb_time *cb_time;
+	struct list_head *cb_tbl;
 	bool cb_tbl_error = false;
 	int enable_counts = 0;
+	u64 start_ns = 0, elapsed_ns;
 
 	pr_debug("irq_idx=%d\n", irq_idx);
 
-	spin_lock_irqsave(&sde_kms->irq_obj.cb_lock, irq_flags);
-	if (list_empty(&irq_obj->irq_cb_tbl[irq_idx])) {
-		/* print error outside lock */
+	/* the tables are only freed a grace period after being cleared */
+	rcu_read_lock();
+	cb_tbl = READ_ONCE(irq_obj->irq_cb_tbl);
+	if (!cb_tbl) {
+		rcu_read_unlock();
+		goto clear;
+	}
+
+	if (list_empty(&cb_tbl[irq_idx])) {
 		cb_tbl_error = true;
 		enable_counts = atomic_read(
 				&sde_kms->irq_obj.enable_counts[irq_idx]);
@@ -39,13 +67,24 @@ static void sde_core_irq_callback_handler(void *arg, int irq_idx)
 
 	atomic_inc(&irq_obj->irq_counts[irq_idx]);
 
+	if (irq_obj->cb_timing)
+		start_ns = ktime_get_ns();
+
 	/*
 	 * Perform registered function callback
 	 */
-	list_for_each_entry(cb, &irq_obj->irq_cb_tbl[irq_idx], list)
-		if (cb->func)
-			cb->func(cb->arg, irq_idx);
-	spin_unlock_irqrestore(&sde_kms->irq_obj.cb_lock, irq_flags);
+	list_for_each_entry_rcu(node, &cb_tbl[irq_idx], list)
+		node->func(node->arg, irq_idx);
+
+	/* dispatches of one irq_idx are serialized by the top-level lock */
+	if (irq_obj->cb_timing) {
+		elapsed_ns = ktime_get_ns() - start_ns;
+		cb_time = &irq_obj->cb_time[irq_idx];
+		cb_time->count++;
+		cb_time->total_ns += elapsed_ns;
+		cb_time->max_ns = max(cb_time->max_ns, elapsed_ns);
+	}
+	rcu_read_unlock();
 
 	if (cb_tbl_error) {
 		/*
@@ -66,6 +105,7 @@ static void sde_core_irq_callback_handler(void *arg, int irq_idx)
 		}
 	}
 
+clear:
 	/*
 	 * Clear pending interrupt status in HW.
 	 * NOTE: sde_core_irq_callback_handler is protected by top-level
@@ -278,9 +318,33 @@ u32 sde_core_irq_read(struct sde_kms *sde_kms, int irq_idx, bool clear)
 			irq_idx, clear);
 }
 
+/**
+ * _sde_core_irq_remove_callback - unlink the node of a callback of an irq
+ * @irq_obj:		Pointer to irq object
+ * @irq_idx:		Interrupt index
+ * @irq_cb:		Registered callback
+ *
+ * Caller must hold cb_lock. The node is freed once no handler can still be
+ * walking it, but a handler running on another cpu may still call it.
+ */
+static void _sde_core_irq_remove_callback(struct sde_irq *irq_obj,
+		int irq_idx, struct sde_irq_callback *irq_cb)
+{
+	struct sde_irq_cb_node *node;
+
+	list_for_each_entry(node, &irq_obj->irq_cb_tbl[irq_idx], list) {
+		if (node->cb == irq_cb) {
+			list_del_rcu(&node->list);
+			kfree_rcu(node, rcu);
+			return;
+		}
+	}
+}
+
 int sde_core_irq_register_callback(struct sde_kms *sde_kms, int irq_idx,
 		struct sde_irq_callback *register_irq_cb)
 {
+	struct sde_irq_cb_node *node;
 	unsigned long irq_flags;
 
 	if (!sde_kms || !sde_kms->irq_obj.irq_cb_tbl) {
@@ -303,11 +367,20 @@ int sde_core_irq_register_callback(struct sde_kms *sde_kms, int irq_idx,
 
 	SDE_DEBUG("[%pS] irq_idx=%d\n", __builtin_return_address(0), irq_idx);
 
+	/* callers may hold their own spinlocks */
+	node = kzalloc(sizeof(*node), GFP_ATOMIC);
+	if (!node)
+		return -ENOMEM;
+
+	node->cb = register_irq_cb;
+	node->func = register_irq_cb->func;
+	node->arg = register_irq_cb->arg;
+
 	spin_lock_irqsave(&sde_kms->irq_obj.cb_lock, irq_flags);
 	SDE_EVT32(irq_idx, register_irq_cb);
-	list_del_init(&register_irq_cb->list);
-	list_add_tail(&register_irq_cb->list,
-			&sde_kms->irq_obj.irq_cb_tbl[irq_idx]);
+	_sde_core_irq_remove_callback(&sde_kms->irq_obj, irq_idx,
+			register_irq_cb);
+	list_add_tail_rcu(&node->list, &sde_kms->irq_obj.irq_cb_tbl[irq_idx]);
 	spin_unlock_irqrestore(&sde_kms->irq_obj.cb_lock, irq_flags);
 
 	return 0;
@@ -340,7 +413,8 @@ int sde_core_irq_unregister_callback(struct sde_kms *sde_kms, int irq_idx,
 
 	spin_lock_irqsave(&sde_kms->irq_obj.cb_lock, irq_flags);
 	SDE_EVT32(irq_idx, register_irq_cb);
-	list_del_init(&register_irq_cb->list);
+	_sde_core_irq_remove_callback(&sde_kms->irq_obj, irq_idx,
+			register_irq_cb);
 	/* empty callback list but interrupt is still enabled */
 	if (list_empty(&sde_kms->irq_obj.irq_cb_tbl[irq_idx]) &&
 			atomic_read(&sde_kms->irq_obj.enable_counts[irq_idx]))
@@ -385,8 +459,9 @@ static const struct file_operations __prefix ## _fops = {		\
 static int sde_debugfs_core_irq_show(struct seq_file *s, void *v)
 {
 	struct sde_irq *irq_obj = s->private;
-	struct sde_irq_callback *cb;
+	struct sde_irq_cb_node *node;
 	unsigned long irq_flags;
+	struct sde_irq_cb_time cb_time;
 	int i, irq_count, enable_count, cb_count;
 
 	if (!irq_obj || !irq_obj->enable_counts || !irq_obj->irq_cb_tbl) {
@@ -399,13 +474,21 @@ static int sde_debugfs_core_irq_show(struct seq_file *s, void *v)
 		cb_count = 0;
 		irq_count = atomic_read(&irq_obj->irq_counts[i]);
 		enable_count = atomic_read(&irq_obj->enable_counts[i]);
-		list_for_each_entry(cb, &irq_obj->irq_cb_tbl[i], list)
+		cb_time = irq_obj->cb_time[i];
+		list_for_each_entry(node, &irq_obj->irq_cb_tbl[i], list)
 			cb_count++;
 		spin_unlock_irqrestore(&irq_obj->cb_lock, irq_flags);
 
-		if (irq_count || enable_count || cb_count)
-			seq_printf(s, "idx:%d irq:%d enable:%d cb:%d\n",
-					i, irq_count, enable_count, cb_count);
+		if (!irq_count && !enable_count && !cb_count)
+			continue;
+
+		seq_printf(s, "idx:%d irq:%d enable:%d cb:%d",
+				i, irq_count, enable_count, cb_count);
+		if (cb_time.count)
+			seq_printf(s, " avg_ns:%llu max_ns:%llu",
+					div64_u64(cb_time.total_ns,
+					cb_time.count), cb_time.max_ns);
+		seq_puts(s, "\n");
 	}
 
 	return 0;
@@ -419,6 +502,9 @@ int sde_debugfs_core_irq_init(struct sde_kms *sde_kms,
 	sde_kms->irq_obj.debugfs_file = debugfs_create_file("core_irq", 0400,
 			parent, &sde_kms->irq_obj,
 			&sde_debugfs_core_irq_fops);
+	sde_kms->irq_obj.debugfs_timing = debugfs_create_bool(
+			"core_irq_timing", 0600, parent,
+			&sde_kms->irq_obj.cb_timing);
 
 	return 0;
 }
@@ -427,6 +513,8 @@ void sde_debugfs_core_irq_destroy(struct sde_kms *sde_kms)
 {
 	debugfs_remove(sde_kms->irq_obj.debugfs_file);
 	sde_kms->irq_obj.debugfs_file = NULL;
+	debugfs_remove(sde_kms->irq_obj.debugfs_timing);
+	sde_kms->irq_obj.debugfs_timing = NULL;
 }
 
 #else
@@ -475,8 +563,11 @@ void sde_core_irq_preinstall(struct sde_kms *sde_kms)
 			sizeof(atomic_t), GFP_KERNEL);
 	sde_kms->irq_obj.irq_counts = kcalloc(sde_kms->irq_obj.total_irqs,
 			sizeof(atomic_t), GFP_KERNEL);
+	sde_kms->irq_obj.cb_time = kcalloc(sde_kms->irq_obj.total_irqs,
+			sizeof(struct sde_irq_cb_time), GFP_KERNEL);
 	if (!sde_kms->irq_obj.irq_cb_tbl || !sde_kms->irq_obj.enable_counts
-			|| !sde_kms->irq_obj.irq_counts)
+			|| !sde_kms->irq_obj.irq_counts
+			|| !sde_kms->irq_obj.cb_time)
 		return;
 
 	for (i = 0; i < sde_kms->irq_obj.total_irqs; i++) {
@@ -496,7 +587,9 @@ int sde_core_irq_postinstall(struct sde_kms *sde_kms)
 
 void sde_core_irq_uninstall(struct sde_kms *sde_kms)
 {
-	int i;
+	struct sde_irq_cb_node *node, *tmp;
+	struct list_head *cb_tbl;
+	int i, total_irqs;
 	int rc;
 	unsigned long irq_flags;
 
@@ -522,14 +615,25 @@ void sde_core_irq_uninstall(struct sde_kms *sde_kms)
 	pm_runtime_put_sync(sde_kms->dev->dev);
 
 	spin_lock_irqsave(&sde_kms->irq_obj.cb_lock, irq_flags);
-	kfree(sde_kms->irq_obj.irq_cb_tbl);
+	cb_tbl = sde_kms->irq_obj.irq_cb_tbl;
+	total_irqs = sde_kms->irq_obj.total_irqs;
+	WRITE_ONCE(sde_kms->irq_obj.irq_cb_tbl, NULL);
+	sde_kms->irq_obj.total_irqs = 0;
+	spin_unlock_irqrestore(&sde_kms->irq_obj.cb_lock, irq_flags);
+
+	/* wait for the handlers that may still walk the old tables */
+	synchronize_rcu();
+
+	for (i = 0; cb_tbl && i < total_irqs; i++)
+		list_for_each_entry_safe(node, tmp, &cb_tbl[i], list)
+			kfree(node);
+	kfree(cb_tbl);
 	kfree(sde_kms->irq_obj.enable_counts);
 	kfree(sde_kms->irq_obj.irq_counts);
-	sde_kms->irq_obj.irq_cb_tbl = NULL;
+	kfree(sde_kms->irq_obj.cb_time);
 	sde_kms->irq_obj.enable_counts = NULL;
 	sde_kms->irq_obj.irq_counts = NULL;
-	sde_kms->irq_obj.total_irqs = 0;
-	spin_unlock_irqrestore(&sde_kms->irq_obj.cb_lock, irq_flags);
+	sde_kms->irq_obj.cb_time = NULL;
 }
 
 static void sde_core_irq_mask(struct irq_data *irqd)
@@ -27,6 +27,9 @@
 #define SDE_PERF_MODE_STRING_SIZE	128
 #define SDE_PERF_THRESHOLD_HIGH_MIN     12800000
 
+/* shortest hold of a vote lowered by the expiry work, about one frame */
+#define SDE_PERF_VOTE_HOLD_MIN_MS	16
+
 #define GET_H32(val) (val >> 32)
 #define GET_L32(val) (val & 0xffffffff)
 
@@ -640,49 +643,232 @@ exit:
 	mutex_unlock(&sde_core_perf_lock);
 }
 
+/* recomputes the max ib of one client type and bus from the contributions */
+static void _sde_core_perf_bw_agg_rescan(struct sde_core_perf_bw_agg *agg,
+		u32 client, u32 bus_id)
+{
+	struct sde_core_perf_bw_contrib *contrib;
+	u64 ib = 0;
+	int i;
+
+	for (i = 0; i < MAX_CRTCS; i++) {
+		contrib = &agg->crtc[i];
+		if (contrib->active && contrib->client == client)
+			ib = max(ib, contrib->max_per_pipe_ib[bus_id]);
+	}
+
+	agg->max_per_pipe_ib[client][bus_id] = ib;
+}
+
+void sde_core_perf_bw_agg_account(struct sde_core_perf_bw_agg *agg,
+		u32 idx, bool active, u32 client,
+		const struct sde_core_perf_params *params)
+{
+	struct sde_core_perf_bw_contrib *contrib;
+	unsigned long rescan = 0;
+	u32 bus_id, bit;
+
+	BUILD_BUG_ON(SDE_PERF_CLIENT_TYPE_MAX *
+			SDE_POWER_HANDLE_DBUS_ID_MAX > BITS_PER_LONG);
+
+	if (idx >= MAX_CRTCS || client >= SDE_PERF_CLIENT_TYPE_MAX)
+		return;
+
+	contrib = &agg->crtc[idx];
+	if (contrib->active == active && (!active ||
+			(contrib->client == client &&
+			!memcmp(contrib->bw_ctl, params->bw_ctl,
+				sizeof(contrib->bw_ctl)) &&
+			!memcmp(contrib->max_per_pipe_ib,
+				params->max_per_pipe_ib,
+				sizeof(contrib->max_per_pipe_ib)))))
+		return;
+
+	if (contrib->active) {
+		for (bus_id = 0; bus_id < SDE_POWER_HANDLE_DBUS_ID_MAX;
+				bus_id++) {
+			agg->bw_sum[contrib->client][bus_id] -=
+					contrib->bw_ctl[bus_id];
+
+			/* the max can only drop if this crtc held it */
+			if (contrib->max_per_pipe_ib[bus_id] &&
+					contrib->max_per_pipe_ib[bus_id] ==
+					agg->max_per_pipe_ib[contrib->client]
+					[bus_id])
+				rescan |= BIT(contrib->client *
+					SDE_POWER_HANDLE_DBUS_ID_MAX + bus_id);
+		}
+	}
+
+	contrib->active = active;
+	if (active) {
+		contrib->client = client;
+		for (bus_id = 0; bus_id < SDE_POWER_HANDLE_DBUS_ID_MAX;
+				bus_id++) {
+			contrib->bw_ctl[bus_id] = params->bw_ctl[bus_id];
+			contrib->max_per_pipe_ib[bus_id] =
+					params->max_per_pipe_ib[bus_id];
+
+			agg->bw_sum[client][bus_id] += contrib->bw_ctl[bus_id];
+			agg->max_per_pipe_ib[client][bus_id] =
+				max(agg->max_per_pipe_ib[client][bus_id],
+				contrib->max_per_pipe_ib[bus_id]);
+		}
+	}
+
+	for_each_set_bit(bit, &rescan,
+			SDE_PERF_CLIENT_TYPE_MAX * SDE_POWER_HANDLE_DBUS_ID_MAX)
+		_sde_core_perf_bw_agg_rescan(agg,
+				bit / SDE_POWER_HANDLE_DBUS_ID_MAX,
+				bit % SDE_POWER_HANDLE_DBUS_ID_MAX);
+}
+
+void sde_core_perf_bw_agg_get(const struct sde_core_perf_bw_agg *agg,
+		unsigned long client_mask, u32 bus_id,
+		u64 *bw_sum, u64 *max_per_pipe_ib)
+{
+	u32 client;
+
+	*bw_sum = 0;
+	*max_per_pipe_ib = 0;
+	if (bus_id >= SDE_POWER_HANDLE_DBUS_ID_MAX)
+		return;
+
+	for_each_set_bit(client, &client_mask, SDE_PERF_CLIENT_TYPE_MAX) {
+		*bw_sum += agg->bw_sum[client][bus_id];
+		*max_per_pipe_ib = max(*max_per_pipe_ib,
+				agg->max_per_pipe_ib[client][bus_id]);
+	}
+}
+
+/**
+ * _sde_core_perf_vote_govern - apply hysteresis to a bus or clock vote
+ * @perf: Pointer to core perf context
+ * @gov: governor state of the vote
+ * @vals: requested values, updated in place with the values to vote
+ * @count: number of values
+ * @headroom: true to pad raised values with the up headroom
+ * @force: true to vote the requested values as is
+ *
+ * Raised values are voted right away. Lower values are held back until the
+ * drop exceeds the down threshold, was requested hold_frames times in a row
+ * and the previous vote is at least hold_ms old. A request to drop all
+ * values to zero is never held back. A held back vote is applied by the
+ * vote work once its hold time expired, in case no other update comes.
+ *
+ * Return: false if the vote is suppressed and must not be sent
+ */
+static bool _sde_core_perf_vote_govern(struct sde_core_perf *perf,
+		struct sde_core_perf_vote_gov *gov, u64 *vals, u32 count,
+		bool headroom, bool force)
+{
+	struct sde_core_perf_vote_tune *tune = &perf->vote_tune;
+	bool raise = false, lower = false, zero = true, held = false;
+	bool significant[ARRAY_SIZE(gov->voted)];
+	ktime_t now = ktime_get();
+	bool lower_ok;
+	s64 hold_ms;
+	u32 i;
+
+	for (i = 0; i < count; i++) {
+		significant[i] = (vals[i] < gov->voted[i]) &&
+			(gov->voted[i] - vals[i]) * 100 >
+			gov->voted[i] * tune->down_threshold;
+		raise |= vals[i] > gov->voted[i];
+		lower |= significant[i];
+		zero &= !vals[i];
+	}
+
+	gov->lower_cnt = lower ? gov->lower_cnt + 1 : 0;
+	lower_ok = force || zero || ((gov->lower_cnt >= tune->hold_frames) &&
+		(ktime_ms_delta(now, gov->voted_ts) >= tune->hold_ms));
+
+	for (i = 0; i < count && !force && !zero; i++) {
+		if (vals[i] > gov->voted[i]) {
+			if (headroom)
+				vals[i] += div_u64(vals[i] * tune->up_headroom,
+						100);
+		} else if (vals[i] < gov->voted[i] &&
+				!(significant[i] && lower_ok)) {
+			vals[i] = gov->voted[i];
+			held = true;
+		}
+	}
+
+	if (held && !raise) {
+		hold_ms = max_t(s64, tune->hold_ms, SDE_PERF_VOTE_HOLD_MIN_MS) -
+				ktime_ms_delta(now, gov->voted_ts);
+		queue_delayed_work(system_wq, &perf->vote_work,
+				msecs_to_jiffies(max_t(s64, hold_ms, 0)));
+		perf->vote_suppressed++;
+		gov->held = true;
+		return false;
+	}
+
+	for (i = 0; i < count; i++)
+		gov->voted[i] = vals[i];
+	gov->voted_ts = now;
+	gov->held = false;
+	if (lower_ok)
+		gov->lower_cnt = 0;
+
+	return true;
+}
+
+/**
+ * _sde_core_perf_crtc_account - sync the running bandwidth totals with the
+ *	current votes of a crtc, caller must hold the core perf lock
+ * @kms: Pointer to sde kms
+ * @crtc: Pointer to crtc
+ * @active: true if the crtc votes, false if it is stopped
+ */
+static void _sde_core_perf_crtc_account(struct sde_kms *kms,
+		struct drm_crtc *crtc, bool active)
+{
+	sde_core_perf_bw_agg_account(&kms->perf.bw_agg, drm_crtc_index(crtc),
+			active, sde_crtc_get_client_type(crtc),
+			&to_sde_crtc(crtc)->cur_perf);
+}
+
 static void _sde_core_perf_crtc_update_bus(struct sde_kms *kms,
-		struct drm_crtc *crtc, u32 bus_id)
+		struct drm_crtc *crtc, u32 bus_id, bool stop_req)
 {
-	u64 bw_sum_of_intfs = 0, bus_ab_quota, bus_ib_quota;
-	struct sde_core_perf_params perf = { { 0 } };
+	u64 bw_sum_of_intfs, max_per_pipe_ib;
+	u64 bus_ab_quota, bus_ib_quota, quota[2];
 	enum sde_crtc_client_type client_vote, curr_client_type
 					= sde_crtc_get_client_type(crtc);
-	struct drm_crtc *tmp_crtc;
+	unsigned long client_mask = GENMASK(SDE_PERF_CLIENT_TYPE_MAX - 1, 0);
 	struct sde_crtc_state *sde_cstate;
 	struct msm_drm_private *priv = kms->dev->dev_private;
-	struct sde_crtc *sde_crtc;
-
-	u64 tmp_max_per_pipe_ib;
-	u64 tmp_bw_ctl;
 
-	drm_for_each_crtc(tmp_crtc, crtc->dev) {
-		if (_sde_core_perf_crtc_is_power_on(tmp_crtc) &&
-		    _is_crtc_client_type_matches(tmp_crtc, curr_client_type,
-								&kms->perf)) {
-
-			/* use current perf, which are the values voted */
-			sde_crtc = to_sde_crtc(tmp_crtc);
-			tmp_max_per_pipe_ib =
-			  sde_crtc->cur_perf.max_per_pipe_ib[bus_id];
-			tmp_bw_ctl =
-			  sde_crtc->cur_perf.bw_ctl[bus_id];
-
-			perf.max_per_pipe_ib[bus_id] =
-				max(perf.max_per_pipe_ib[bus_id],
-				tmp_max_per_pipe_ib);
+	if (kms->perf.bw_vote_mode == DISP_RSC_PRIMARY_MODE &&
+			kms->perf.sde_rsc_available)
+		client_mask = BIT(curr_client_type);
+	sde_core_perf_bw_agg_get(&kms->perf.bw_agg, client_mask, bus_id,
+			&bw_sum_of_intfs, &max_per_pipe_ib);
 
-			bw_sum_of_intfs += tmp_bw_ctl;
+	SDE_DEBUG("crtc=%d bus_id=%d bw=%llu perf_pipe:%llu\n",
+			crtc->base.id, bus_id, bw_sum_of_intfs,
+			max_per_pipe_ib);
 
-			SDE_DEBUG("crtc=%d bus_id=%d bw=%llu perf_pipe:%llu\n",
-				tmp_crtc->base.id, bus_id,
-				tmp_bw_ctl, tmp_max_per_pipe_ib);
-		}
+	client_vote = _get_sde_client_type(curr_client_type, &kms->perf);
+	quota[0] = bw_sum_of_intfs;
+	quota[1] = max_per_pipe_ib;
+	if (client_vote < SDE_PERF_CLIENT_TYPE_MAX &&
+			!_sde_core_perf_vote_govern(&kms->perf,
+			&kms->perf.bus_gov[client_vote][bus_id], quota,
+			ARRAY_SIZE(quota), true, stop_req ||
+			kms->perf.perf_tune.mode != SDE_PERF_MODE_NORMAL)) {
+		SDE_EVT32_VERBOSE(DRMID(crtc), bus_id, GET_H32(quota[0]),
+				GET_L32(quota[0]), GET_H32(bw_sum_of_intfs),
+				GET_L32(bw_sum_of_intfs));
+		goto update_vote_mode;
 	}
 
-	bus_ab_quota = max(bw_sum_of_intfs, kms->perf.perf_tune.min_bus_vote);
+	bus_ab_quota = max(quota[0], kms->perf.perf_tune.min_bus_vote);
 	bus_ab_quota = min(bus_ab_quota,
 			kms->catalog->perf.max_bw_high*1000ULL);
-	bus_ib_quota = perf.max_per_pipe_ib[bus_id];
+	bus_ib_quota = quota[1];
 
 	if (kms->perf.perf_tune.mode == SDE_PERF_MODE_FIXED) {
 		bus_ab_quota = max(kms->perf.fix_core_ab_vote,
@@ -691,7 +877,6 @@ static void _sde_core_perf_crtc_update_bus(struct sde_kms *kms,
 					bus_ib_quota);
 	}
 
-	client_vote = _get_sde_client_type(curr_client_type, &kms->perf);
 	switch (client_vote) {
 	case RT_CLIENT:
 		sde_power_data_bus_set_quota(&priv->phandle,
@@ -713,6 +898,7 @@ static void _sde_core_perf_crtc_update_bus(struct sde_kms *kms,
 		break;
 	}
 
+update_vote_mode:
 	if (kms->perf.bw_vote_mode_updated) {
 		switch (kms->perf.bw_vote_mode) {
 		case DISP_RSC_MODE:
@@ -787,13 +973,40 @@ void sde_core_perf_crtc_release_bw(struct drm_crtc *crtc)
 	if (kms->perf.enable_bw_release) {
 		trace_sde_cmd_release_bw(crtc->base.id);
 		SDE_DEBUG("Release BW crtc=%d\n", crtc->base.id);
-		for (i = 0; i < SDE_POWER_HANDLE_DBUS_ID_MAX; i++) {
+		mutex_lock(&sde_core_perf_lock);
+		for (i = 0; i < SDE_POWER_HANDLE_DBUS_ID_MAX; i++)
 			sde_crtc->cur_perf.bw_ctl[i] = 0;
-			_sde_core_perf_crtc_update_bus(kms, crtc, i);
-		}
+		_sde_core_perf_crtc_account(kms, crtc,
+				_sde_core_perf_crtc_is_power_on(crtc));
+		for (i = 0; i < SDE_POWER_HANDLE_DBUS_ID_MAX; i++)
+			_sde_core_perf_crtc_update_bus(kms, crtc, i, true);
+		mutex_unlock(&sde_core_perf_lock);
 	}
 }
 
+void sde_core_perf_crtc_clear_perf(struct drm_crtc *crtc)
+{
+	struct sde_kms *kms;
+
+	if (!crtc) {
+		SDE_ERROR("invalid crtc\n");
+		return;
+	}
+
+	kms = _sde_crtc_get_kms(crtc);
+	if (!kms) {
+		SDE_ERROR("invalid kms\n");
+		return;
+	}
+
+	mutex_lock(&sde_core_perf_lock);
+	memset(&to_sde_crtc(crtc)->cur_perf, 0,
+			sizeof(struct sde_core_perf_params));
+	_sde_core_perf_crtc_account(kms, crtc,
+			_sde_core_perf_crtc_is_power_on(crtc));
+	mutex_unlock(&sde_core_perf_lock);
+}
+
 static u64 _sde_core_perf_get_core_clk_rate(struct sde_kms *kms)
 {
 	u64 clk_rate = kms->perf.perf_tune.min_core_clk;
@@ -822,6 +1035,66 @@ static u64 _sde_core_perf_get_core_clk_rate(struct sde_kms *kms)
 	return clk_rate;
 }
 
+/**
+ * _sde_core_perf_vote_work - apply the votes held back by the governor
+ * @work: vote_work of the core perf context
+ *
+ * Runs once the hold time of a held back vote expired. No update came in
+ * since, so the idle time counts for the frames the vote still had to be
+ * held for.
+ */
+static void _sde_core_perf_vote_work(struct work_struct *work)
+{
+	struct sde_core_perf *perf = container_of(to_delayed_work(work),
+			struct sde_core_perf, vote_work);
+	struct sde_kms *kms = container_of(perf, struct sde_kms, perf);
+	struct sde_core_perf_vote_gov *gov;
+	struct drm_crtc *crtc;
+	u32 client, bus_id;
+	u64 clk_rate;
+
+	mutex_lock(&sde_core_perf_lock);
+	drm_for_each_crtc(crtc, perf->dev) {
+		if (!_sde_core_perf_crtc_is_power_on(crtc))
+			continue;
+
+		client = _get_sde_client_type(sde_crtc_get_client_type(crtc),
+				perf);
+		if (client >= SDE_PERF_CLIENT_TYPE_MAX)
+			continue;
+
+		for (bus_id = 0; bus_id < SDE_POWER_HANDLE_DBUS_ID_MAX;
+				bus_id++) {
+			gov = &perf->bus_gov[client][bus_id];
+			if (!gov->held)
+				continue;
+
+			gov->lower_cnt = max(gov->lower_cnt,
+					perf->vote_tune.hold_frames);
+			_sde_core_perf_crtc_update_bus(kms, crtc, bus_id,
+					false);
+		}
+	}
+
+	gov = &perf->clk_gov;
+	if (gov->held) {
+		gov->lower_cnt = max(gov->lower_cnt,
+				perf->vote_tune.hold_frames);
+		clk_rate = _sde_core_perf_get_core_clk_rate(kms);
+		if (_sde_core_perf_vote_govern(perf, gov, &clk_rate, 1, false,
+				false)) {
+			SDE_EVT32(kms->dev, clk_rate, perf->core_clk_rate);
+			if (sde_power_clk_set_rate(perf->phandle,
+					perf->clk_name, clk_rate))
+				SDE_ERROR("failed to set %s clock rate %llu\n",
+						perf->clk_name, clk_rate);
+			else
+				perf->core_clk_rate = clk_rate;
+		}
+	}
+	mutex_unlock(&sde_core_perf_lock);
+}
+
 static void _sde_core_perf_crtc_update_check(struct drm_crtc *crtc,
 		int params_changed,
 		int *update_bus, int *update_clk)
@@ -917,6 +1190,7 @@ void sde_core_perf_crtc_update(struct drm_crtc *crtc,
 {
 	struct sde_core_perf_params *new, *old;
 	int update_bus = 0, update_clk = 0;
+	bool active;
 	u64 clk_rate = 0;
 	struct sde_crtc *sde_crtc;
 	struct sde_crtc_state *sde_cstate;
@@ -955,7 +1229,8 @@ void sde_core_perf_crtc_update(struct drm_crtc *crtc,
 	old = &sde_crtc->cur_perf;
 	new = &sde_crtc->new_perf;
 
-	if (_sde_core_perf_crtc_is_power_on(crtc) && !stop_req) {
+	active = _sde_core_perf_crtc_is_power_on(crtc) && !stop_req;
+	if (active) {
 		_sde_core_perf_crtc_update_check(crtc, params_changed,
 				&update_bus, &update_clk);
 	} else {
@@ -965,6 +1240,7 @@ void sde_core_perf_crtc_update(struct drm_crtc *crtc,
 		update_bus = ~0;
 		update_clk = 1;
 	}
+	_sde_core_perf_crtc_account(kms, crtc, active);
 	trace_sde_perf_crtc_update(crtc->base.id,
 		new->bw_ctl[SDE_POWER_HANDLE_DBUS_ID_MNOC],
 		new->max_per_pipe_ib[SDE_POWER_HANDLE_DBUS_ID_MNOC],
@@ -977,7 +1253,7 @@ void sde_core_perf_crtc_update(struct drm_crtc *crtc,
 
 	for (i = 0; i < SDE_POWER_HANDLE_DBUS_ID_MAX; i++) {
 		if (update_bus & BIT(i))
-			_sde_core_perf_crtc_update_bus(kms, crtc, i);
+			_sde_core_perf_crtc_update_bus(kms, crtc, i, stop_req);
 	}
 
 	if (kms->perf.bw_vote_mode == DISP_RSC_MODE &&
@@ -994,6 +1270,16 @@ void sde_core_perf_crtc_update(struct drm_crtc *crtc,
 	if (update_clk) {
 		clk_rate = _sde_core_perf_get_core_clk_rate(kms);
 
+		if (!_sde_core_perf_vote_govern(&kms->perf,
+				&kms->perf.clk_gov, &clk_rate, 1, false,
+				stop_req || kms->perf.perf_tune.mode !=
+				SDE_PERF_MODE_NORMAL)) {
+			SDE_EVT32_VERBOSE(kms->dev, clk_rate,
+					kms->perf.core_clk_rate);
+			mutex_unlock(&sde_core_perf_lock);
+			return;
+		}
+
 		SDE_EVT32(kms->dev, stop_req, clk_rate, params_changed,
 			old->core_clk_rate, new->core_clk_rate);
 		ret = sde_power_clk_set_rate(&priv->phandle,
@@ -1224,6 +1510,16 @@ int sde_core_perf_debugfs_init(struct sde_core_perf *perf,
 			&perf->fix_core_ib_vote);
 	debugfs_create_u64("fix_core_ab_vote", 0600, perf->debugfs_root,
 			&perf->fix_core_ab_vote);
+	debugfs_create_u32("vote_up_headroom", 0600, perf->debugfs_root,
+			&perf->vote_tune.up_headroom);
+	debugfs_create_u32("vote_down_threshold", 0600, perf->debugfs_root,
+			&perf->vote_tune.down_threshold);
+	debugfs_create_u32("vote_hold_frames", 0600, perf->debugfs_root,
+			&perf->vote_tune.hold_frames);
+	debugfs_create_u32("vote_hold_ms", 0600, perf->debugfs_root,
+			&perf->vote_tune.hold_ms);
+	debugfs_create_u64("vote_suppressed", 0600, perf->debugfs_root,
+			&perf->vote_suppressed);
 	debugfs_create_bool("idle_sys_cache_enable", 0600, perf->debugfs_root,
 			&perf->idle_sys_cache_enabled);
 
@@ -1253,6 +1549,7 @@ void sde_core_perf_destroy(struct sde_core_perf *perf)
 		return;
 	}
 
+	cancel_delayed_work_sync(&perf->vote_work);
 	sde_core_perf_debugfs_destroy(perf);
 	perf->max_core_clk_rate = 0;
 	perf->core_clk = NULL;
@@ -1277,6 +1574,7 @@ int sde_core_perf_init(struct sde_core_perf *perf,
 	perf->catalog = catalog;
 	perf->phandle = phandle;
 	perf->clk_name = clk_name;
+	INIT_DELAYED_WORK(&perf->vote_work, _sde_core_perf_vote_work);
 	perf->sde_rsc_available = is_sde_rsc_available(SDE_RSC_INDEX);
 	/* set default mode */
 	if (perf->sde_rsc_available)
@@ -9,13 +9,32 @@
 #include <linux/types.h>
 #include <linux/dcache.h>
 #include <linux/mutex.h>
+#include <linux/ktime.h>
+#include <linux/workqueue.h>
 #include <drm/drm_crtc.h>
 
+#include "msm_drv.h"
 #include "sde_hw_catalog.h"
 #include "sde_power_handle.h"
 
 #define SDE_PERF_DEFAULT_MAX_CORE_CLK_RATE	320000000
 
+/**
+ * enum sde_crtc_client_type: crtc client type
+ * @RT_CLIENT:	RealTime client like video/cmd mode display
+ *              voting through apps rsc
+ * @NRT_CLIENT:	Non-RealTime client like WB display
+ *              voting through apps rsc
+ * @RT_RSC_CLIENT:	Realtime display RSC voting client
+ * @SDE_PERF_CLIENT_TYPE_MAX:	Number of client types
+ */
+enum sde_crtc_client_type {
+	RT_CLIENT,
+	NRT_CLIENT,
+	RT_RSC_CLIENT,
+	SDE_PERF_CLIENT_TYPE_MAX,
+};
+
 /**
  *  uidle performance counters mode
  * @SDE_PERF_UIDLE_DISABLE: Disable logging (default)
@@ -56,6 +75,65 @@ struct sde_core_perf_tune {
 	bool mode_changed;
 };
 
+/**
+ * struct sde_core_perf_vote_tune - debug control of the vote governor
+ * @up_headroom: percentage added on top of a vote when it is raised
+ * @down_threshold: percentage a vote must drop by before it is lowered
+ * @hold_frames: number of consecutive lower requests before lowering a vote
+ * @hold_ms: minimum time in ms a vote is held before it may be lowered
+ *
+ * All fields default to zero, which votes every request as is and so keeps
+ * the governor off until it is tuned through debugfs.
+ */
+struct sde_core_perf_vote_tune {
+	u32 up_headroom;
+	u32 down_threshold;
+	u32 hold_frames;
+	u32 hold_ms;
+};
+
+/**
+ * struct sde_core_perf_vote_gov - state of one governed bus or clock vote
+ * @voted: last voted values, ab and ib for a bus, the rate for the clock
+ * @lower_cnt: number of consecutive requests to lower the vote
+ * @voted_ts: time of the last vote
+ * @held: true if a lower vote is held back and still has to be applied
+ */
+struct sde_core_perf_vote_gov {
+	u64 voted[2];
+	u32 lower_cnt;
+	ktime_t voted_ts;
+	bool held;
+};
+
+/**
+ * struct sde_core_perf_bw_contrib - bandwidth a crtc adds to the bus votes
+ * @active: true if the crtc was powered on when last accounted
+ * @client: client type the bandwidth is accounted to
+ * @max_per_pipe_ib: voted maximum instantaneous bandwidth per bus
+ * @bw_ctl: voted arbitrated bandwidth per bus
+ */
+struct sde_core_perf_bw_contrib {
+	bool active;
+	u32 client;
+	u64 max_per_pipe_ib[SDE_POWER_HANDLE_DBUS_ID_MAX];
+	u64 bw_ctl[SDE_POWER_HANDLE_DBUS_ID_MAX];
+};
+
+/**
+ * struct sde_core_perf_bw_agg - running totals of the crtc bandwidth votes
+ * @bw_sum: sum of bw_ctl of the active crtcs per client type and bus
+ * @max_per_pipe_ib: max of max_per_pipe_ib of the active crtcs per client
+ *	type and bus
+ * @crtc: contribution of each crtc, indexed by drm crtc index
+ */
+struct sde_core_perf_bw_agg {
+	u64 bw_sum[SDE_PERF_CLIENT_TYPE_MAX][SDE_POWER_HANDLE_DBUS_ID_MAX];
+	u64 max_per_pipe_ib[SDE_PERF_CLIENT_TYPE_MAX]
+			[SDE_POWER_HANDLE_DBUS_ID_MAX];
+	struct sde_core_perf_bw_contrib crtc[MAX_CRTCS];
+};
+
 /**
  * struct sde_core_perf - definition of core performance context
  * @dev: Pointer to drm device
@@ -78,6 +156,12 @@ struct sde_core_perf_tune {
  * @uidle_enabled: indicates if uidle is already enabled
  * @idle_sys_cache_enabled: override system cache enable state
  *                          for idle usecase
+ * @bw_agg: running totals of the crtc bandwidth votes
+ * @vote_tune: debug control of the bus and clock vote governor
+ * @bus_gov: governor state per client type and bus
+ * @clk_gov: governor state of the core clock
+ * @vote_suppressed: number of bus and clock votes held back by the governor
+ * @vote_work: applies held back votes once their hold time expired
  */
 struct sde_core_perf {
 	struct drm_device *dev;
@@ -99,6 +183,13 @@ struct sde_core_perf {
 	bool llcc_active[SDE_SYS_CACHE_MAX];
 	bool uidle_enabled;
 	bool idle_sys_cache_enabled;
+	struct sde_core_perf_bw_agg bw_agg;
+	struct sde_core_perf_vote_tune vote_tune;
+	struct sde_core_perf_vote_gov bus_gov[SDE_PERF_CLIENT_TYPE_MAX]
+			[SDE_POWER_HANDLE_DBUS_ID_MAX];
+	struct sde_core_perf_vote_gov clk_gov;
+	u64 vote_suppressed;
+	struct delayed_work vote_work;
 };
 
 /**
@@ -131,6 +222,39 @@ void sde_core_perf_crtc_update(struct drm_crtc *crtc,
  */
 void sde_core_perf_crtc_release_bw(struct drm_crtc *crtc);
 
+/**
+ * sde_core_perf_crtc_clear_perf - clear the current votes of the given crtc
+ *	without voting, the next update votes the new totals
+ * @crtc: Pointer to crtc
+ */
+void sde_core_perf_crtc_clear_perf(struct drm_crtc *crtc);
+
+/**
+ * sde_core_perf_bw_agg_account - replace the bandwidth accounted to a crtc
+ *	in the running totals, called whenever the votes, power state or
+ *	client type of the crtc change, caller must hold the core perf lock
+ * @agg: Pointer to running totals
+ * @idx: drm crtc index
+ * @active: true if the crtc is powered on
+ * @client: client type of the crtc
+ * @params: Pointer to the current votes of the crtc
+ */
+void sde_core_perf_bw_agg_account(struct sde_core_perf_bw_agg *agg,
+		u32 idx, bool active, u32 client,
+		const struct sde_core_perf_params *params);
+
+/**
+ * sde_core_perf_bw_agg_get - read the running totals of one bus
+ * @agg: Pointer to running totals
+ * @client_mask: mask of the client types to include
+ * @bus_id: data bus id
+ * @bw_sum: output, sum of the arbitrated bandwidth
+ * @max_per_pipe_ib: output, max of the instantaneous bandwidth
+ */
+void sde_core_perf_bw_agg_get(const struct sde_core_perf_bw_agg *agg,
+		unsigned long client_mask, u32 bus_id,
+		u64 *bw_sum, u64 *max_per_pipe_ib);
+
 /**
  * sde_core_perf_crtc_update_uidle - attempts to enable uidle of the given crtc
  * @crtc: Pointer to crtc
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#include <kunit/test.h>
+#include <linux/random.h>
+
+#include "sde_core_perf.h"
+#include "sde_crtc.h"
+#include "sde_kunit.h"
+
+#define SDE_CORE_PERF_TEST_ROUNDS	2000
+
+/* votes of every crtc, the way the full walk used to see them */
+struct sde_core_perf_test_crtc {
+	bool active;
+	u32 client;
+	struct sde_core_perf_params params;
+};
+
+/* the full recompute the running totals replace */
+static void sde_core_perf_test_recompute(
+		const struct sde_core_perf_test_crtc *crtcs,
+		unsigned long client_mask, u32 bus_id,
+		u64 *bw_sum, u64 *max_per_pipe_ib)
+{
+	int i;
+
+	*bw_sum = 0;
+	*max_per_pipe_ib = 0;
+	for (i = 0; i < MAX_CRTCS; i++) {
+		if (!crtcs[i].active || !test_bit(crtcs[i].client, &client_mask))
+			continue;
+
+		*bw_sum += crtcs[i].params.bw_ctl[bus_id];
+		*max_per_pipe_ib = max(*max_per_pipe_ib,
+				crtcs[i].params.max_per_pipe_ib[bus_id]);
+	}
+}
+
+static void sde_core_perf_test_expect(struct kunit *test,
+		const struct sde_core_perf_bw_agg *agg,
+		const struct sde_core_perf_test_crtc *crtcs, int round)
+{
+	u64 sum, ib, exp_sum, exp_ib;
+	unsigned long client_mask;
+	u32 bus_id;
+
+	for (client_mask = 1; client_mask < BIT(SDE_PERF_CLIENT_TYPE_MAX);
+			client_mask++) {
+		for (bus_id = 0; bus_id < SDE_POWER_HANDLE_DBUS_ID_MAX;
+				bus_id++) {
+			sde_core_perf_bw_agg_get(agg, client_mask, bus_id,
+					&sum, &ib);
+			sde_core_perf_test_recompute(crtcs, client_mask,
+					bus_id, &exp_sum, &exp_ib);
+			KUNIT_EXPECT_EQ_MSG(test, exp_sum, sum,
+				"round %d clients %lx bus %u", round,
+				client_mask, bus_id);
+			KUNIT_EXPECT_EQ_MSG(test, exp_ib, ib,
+				"round %d clients %lx bus %u", round,
+				client_mask, bus_id);
+		}
+	}
+}
+
+static void sde_core_perf_test_bw_agg_random(struct kunit *test)
+{
+	struct sde_core_perf_test_crtc crtcs[MAX_CRTCS] = { 0 };
+	struct sde_core_perf_bw_agg *agg;
+	struct rnd_state rnd;
+	int round, bus_id;
+
+	agg = kunit_kzalloc(test, sizeof(*agg), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, agg);
+	prandom_seed_state(&rnd, 0x5de);
+
+	for (round = 0; round < SDE_CORE_PERF_TEST_ROUNDS; round++) {
+		struct sde_core_perf_test_crtc *c;
+
+		c = &crtcs[prandom_u32_state(&rnd) % MAX_CRTCS];
+
+		/* small value ranges so equal maxima and drops to 0 happen */
+		switch (prandom_u32_state(&rnd) % 4) {
+		case 0:
+			c->active = !c->active;
+			break;
+		case 1:
+			c->client = prandom_u32_state(&rnd) %
+					SDE_PERF_CLIENT_TYPE_MAX;
+			break;
+		default:
+			for (bus_id = 0; bus_id < SDE_POWER_HANDLE_DBUS_ID_MAX;
+					bus_id++) {
+				c->params.bw_ctl[bus_id] =
+					prandom_u32_state(&rnd) % 8;
+				c->params.max_per_pipe_ib[bus_id] =
+					prandom_u32_state(&rnd) % 8;
+			}
+			break;
+		}
+
+		sde_core_perf_bw_agg_account(agg, c - crtcs, c->active,
+				c->client, &c->params);
+		sde_core_perf_test_expect(test, agg, crtcs, round);
+	}
+}
+
+static void sde_core_perf_test_bw_agg_max_drop(struct kunit *test)
+{
+	struct sde_core_perf_test_crtc crtcs[MAX_CRTCS] = { 0 };
+	struct sde_core_perf_bw_agg *agg;
+	int i;
+
+	agg = kunit_kzalloc(test, sizeof(*agg), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, agg);
+
+	/* two crtcs share the max, then the holders lower their votes */
+	for (i = 0; i < 3; i++) {
+		crtcs[i].active = true;
+		crtcs[i].client = RT_CLIENT;
+		crtcs[i].params.bw_ctl[0] = 100;
+		crtcs[i].params.max_per_pipe_ib[0] = (i < 2) ? 500 : 300;
+		sde_core_perf_bw_agg_account(agg, i, true, RT_CLIENT,
+				&crtcs[i].params);
+	}
+	sde_core_perf_test_expect(test, agg, crtcs, 0);
+
+	crtcs[0].params.max_per_pipe_ib[0] = 200;
+	sde_core_perf_bw_agg_account(agg, 0, true, RT_CLIENT,
+			&crtcs[0].params);
+	sde_core_perf_test_expect(test, agg, crtcs, 1);
+
+	crtcs[1].active = false;
+	sde_core_perf_bw_agg_account(agg, 1, false, RT_CLIENT,
+			&crtcs[1].params);
+	sde_core_perf_test_expect(test, agg, crtcs, 2);
+
+	crtcs[2].client = RT_RSC_CLIENT;
+	sde_core_perf_bw_agg_account(agg, 2, true, RT_RSC_CLIENT,
+			&crtcs[2].params);
+	sde_core_perf_test_expect(test, agg, crtcs, 3);
+}
+
+static struct kunit_case sde_core_perf_test_cases[] = {
+	KUNIT_CASE(sde_core_perf_test_bw_agg_random),
+	KUNIT_CASE(sde_core_perf_test_bw_agg_max_drop),
+	{}
+};
+
+struct kunit_suite sde_core_perf_test_suite = {
+	.name = "sde_core_perf",
+	.test_cases = sde_core_perf_test_cases,
+};
@@ -161,6 +161,116 @@ static void sde_crtc_calc_fps(struct sde_crtc *sde_crtc)
 	sde_crtc->fps_info.next_time_index %= MAX_FRAME_COUNT;
 }
 
+static const char * const sde_crtc_lat_stage_names[SDE_CRTC_LAT_MAX] = {
+	[SDE_CRTC_LAT_ATOMIC_CHECK] = "atomic_check",
+	[SDE_CRTC_LAT_FENCE_WAIT] = "fence_wait",
+	[SDE_CRTC_LAT_KICKOFF] = "kickoff",
+	[SDE_CRTC_LAT_FRAME_DONE] = "frame_done",
+	[SDE_CRTC_LAT_RETIRE] = "retire",
+};
+
+/**
+ * _sde_crtc_lat_record - account one sample in a commit stage histogram
+ * @sde_crtc: Pointer to sde crtc structure
+ * @stage: commit stage the sample belongs to
+ * @start: ktime at the start of the stage
+ * @end: ktime at the end of the stage
+ */
+static void _sde_crtc_lat_record(struct sde_crtc *sde_crtc,
+		enum sde_crtc_lat_stage stage, ktime_t start, ktime_t end)
+{
+	struct sde_crtc_lat_hist *hist = &sde_crtc->lat_hist;
+	unsigned long flags;
+	s64 us;
+	u32 i;
+
+	/* events of an older frame can complete after the latest kickoff */
+	if (!ktime_to_ns(start) || ktime_before(end, start))
+		return;
+
+	us = ktime_us_delta(end, start);
+	i = us ? min_t(u32, ilog2(us) + 1, SDE_CRTC_LAT_BUCKETS - 1) : 0;
+
+	spin_lock_irqsave(&hist->lock, flags);
+	hist->bucket[stage][i]++;
+	hist->count[stage]++;
+	hist->total_us[stage] += us;
+	hist->max_us[stage] = max_t(u64, hist->max_us[stage], us);
+	spin_unlock_irqrestore(&hist->lock, flags);
+}
+
+/* remembers the end of the kickoff of a frame until its frame done */
+static void _sde_crtc_lat_kickoff(struct sde_crtc *sde_crtc, ktime_t ts)
+{
+	struct sde_crtc_lat_hist *hist = &sde_crtc->lat_hist;
+	unsigned long flags;
+
+	spin_lock_irqsave(&hist->lock, flags);
+	hist->kickoff_ts[hist->kickoff_head % SDE_CRTC_LAT_FRAMES] = ts;
+	hist->kickoff_head++;
+	if (hist->kickoff_head - hist->kickoff_tail > SDE_CRTC_LAT_FRAMES)
+		hist->kickoff_tail = hist->kickoff_head - SDE_CRTC_LAT_FRAMES;
+	spin_unlock_irqrestore(&hist->lock, flags);
+}
+
+/* returns the kickoff time of the oldest pending frame, 0 if none */
+static ktime_t _sde_crtc_lat_frame_done(struct sde_crtc *sde_crtc)
+{
+	struct sde_crtc_lat_hist *hist = &sde_crtc->lat_hist;
+	unsigned long flags;
+	ktime_t ts = 0;
+
+	spin_lock_irqsave(&hist->lock, flags);
+	if (hist->kickoff_tail != hist->kickoff_head) {
+		ts = hist->kickoff_ts[hist->kickoff_tail % SDE_CRTC_LAT_FRAMES];
+		hist->kickoff_tail++;
+	}
+	spin_unlock_irqrestore(&hist->lock, flags);
+
+	return ts;
+}
+
+/* drops the kickoff times of frames that won't see a frame done */
+static void _sde_crtc_lat_frames_reset(struct sde_crtc *sde_crtc)
+{
+	struct sde_crtc_lat_hist *hist = &sde_crtc->lat_hist;
+	unsigned long flags;
+
+	spin_lock_irqsave(&hist->lock, flags);
+	hist->kickoff_tail = hist->kickoff_head;
+	spin_unlock_irqrestore(&hist->lock, flags);
+}
+
+static void _sde_crtc_lat_reset(struct sde_crtc *sde_crtc)
+{
+	struct sde_crtc_lat_hist *hist = &sde_crtc->lat_hist;
+	unsigned long flags;
+
+	spin_lock_irqsave(&hist->lock, flags);
+	memset(hist->bucket, 0, sizeof(hist->bucket));
+	memset(hist->count, 0, sizeof(hist->count));
+	memset(hist->total_us, 0, sizeof(hist->total_us));
+	memset(hist->max_us, 0, sizeof(hist->max_us));
+	spin_unlock_irqrestore(&hist->lock, flags);
+}
+
+/* upper bound in us of the bucket holding the pct percentile, lock held */
+static u64 _sde_crtc_lat_percentile(struct sde_crtc_lat_hist *hist,
+		enum sde_crtc_lat_stage stage, u32 pct)
+{
+	u64 target, sum = 0;
+	u32 i;
+
+	target = DIV_ROUND_UP_ULL((u64)hist->count[stage] * pct, 100);
+	for (i = 0; i < SDE_CRTC_LAT_BUCKETS - 1; i++) {
+		sum += hist->bucket[stage][i];
+		if (sum >= target)
+			return min_t(u64, BIT_ULL(i), hist->max_us[stage]);
+	}
+
+	return hist->max_us[stage];
+}
+
 static void _sde_crtc_deinit_events(struct sde_crtc *sde_crtc)
 {
 	if (!sde_crtc)
@@ -214,6 +324,52 @@ static int _sde_debugfs_fps_status(struct inode *inode, struct file *file)
 	return single_open(file, _sde_debugfs_fps_status_show,
 			inode->i_private);
 }
+
+static int _sde_debugfs_latency_show(struct seq_file *s, void *data)
+{
+	struct sde_crtc *sde_crtc = s->private;
+	struct sde_crtc_lat_hist *hist = &sde_crtc->lat_hist;
+	unsigned long flags;
+	u32 stage, i;
+
+	spin_lock_irqsave(&hist->lock, flags);
+	for (stage = 0; stage < SDE_CRTC_LAT_MAX; stage++) {
+		seq_printf(s, "%s: count:%u total_us:%llu max_us:%llu\n",
+				sde_crtc_lat_stage_names[stage],
+				hist->count[stage], hist->total_us[stage],
+				hist->max_us[stage]);
+		for (i = 0; i < SDE_CRTC_LAT_BUCKETS; i++) {
+			if (!hist->bucket[stage][i])
+				continue;
+			if (i == SDE_CRTC_LAT_BUCKETS - 1)
+				seq_printf(s, "\t>=%lluus: %u\n",
+						BIT_ULL(i - 1),
+						hist->bucket[stage][i]);
+			else
+				seq_printf(s, "\t<%lluus: %u\n", BIT_ULL(i),
+						hist->bucket[stage][i]);
+		}
+	}
+	spin_unlock_irqrestore(&hist->lock, flags);
+
+	return 0;
+}
+
+static int _sde_debugfs_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, _sde_debugfs_latency_show, inode->i_private);
+}
+
+static ssize_t _sde_debugfs_latency_write(struct file *file,
+		const char __user *user_buf, size_t count, loff_t *ppos)
+{
+	struct seq_file *s = file->private_data;
+
+	/* any write resets the histograms */
+	_sde_crtc_lat_reset(s->private);
+
+	return count;
+}
 #endif
 
 static ssize_t fps_periodicity_ms_store(struct device *device,
@@ -398,16 +554,70 @@ static ssize_t retire_frame_event_show(struct device *device,
 			ktime_to_ns(sde_crtc->retire_frame_event_time));
 }
 
+static ssize_t commit_latency_show(struct device *device,
+	struct device_attribute *attr, char *buf)
+{
+	struct drm_crtc *crtc;
+	struct sde_crtc_lat_hist *hist;
+	unsigned long flags;
+	ssize_t len = 0;
+	u32 stage;
+
+	if (!device || !buf) {
+		SDE_ERROR("invalid input param(s)\n");
+		return -EAGAIN;
+	}
+
+	crtc = dev_get_drvdata(device);
+	hist = &to_sde_crtc(crtc)->lat_hist;
+
+	spin_lock_irqsave(&hist->lock, flags);
+	for (stage = 0; stage < SDE_CRTC_LAT_MAX; stage++)
+		len += scnprintf(buf + len, PAGE_SIZE - len,
+			"%s count:%u avg_us:%llu p50_us:%llu p99_us:%llu max_us:%llu\n",
+			sde_crtc_lat_stage_names[stage], hist->count[stage],
+			hist->count[stage] ? div_u64(hist->total_us[stage],
+				hist->count[stage]) : 0,
+			_sde_crtc_lat_percentile(hist, stage, 50),
+			_sde_crtc_lat_percentile(hist, stage, 99),
+			hist->max_us[stage]);
+	spin_unlock_irqrestore(&hist->lock, flags);
+
+	return len;
+}
+
+static ssize_t commit_latency_store(struct device *device,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct drm_crtc *crtc;
+
+	if (!device || !buf) {
+		SDE_ERROR("invalid input param(s)\n");
+		return -EAGAIN;
+	}
+
+	crtc = dev_get_drvdata(device);
+	if (!crtc)
+		return -EINVAL;
+
+	/* any write resets the histograms */
+	_sde_crtc_lat_reset(to_sde_crtc(crtc));
+
+	return count;
+}
+
 static DEVICE_ATTR_RO(vsync_event);
 static DEVICE_ATTR_RO(measured_fps);
 static DEVICE_ATTR_RW(fps_periodicity_ms);
 static DEVICE_ATTR_RO(retire_frame_event);
+static DEVICE_ATTR_RW(commit_latency);
 
 static struct attribute *sde_crtc_dev_attrs[] = {
 	&dev_attr_vsync_event.attr,
 	&dev_attr_measured_fps.attr,
 	&dev_attr_fps_periodicity_ms.attr,
 	&dev_attr_retire_frame_event.attr,
+	&dev_attr_commit_latency.attr,
 	NULL
 };
 
@@ -2470,6 +2680,7 @@ static void sde_crtc_frame_event_work(struct kthread_work *work)
 	struct sde_crtc *sde_crtc;
 	struct sde_kms *sde_kms;
 	unsigned long flags;
+	ktime_t kickoff_ts;
 	bool in_clone_mode = false;
 
 	if (!work) {
@@ -2513,17 +2724,25 @@ static void sde_crtc_frame_event_work(struct kthread_work *work)
 					atomic_read(&sde_crtc->frame_pending));
 			SDE_EVT32(DRMID(crtc), fevent->event,
 							SDE_EVTLOG_FUNC_CASE1);
-		} else if (atomic_dec_return(&sde_crtc->frame_pending) == 0) {
-			/* release bandwidth and other resources */
-			SDE_DEBUG("crtc%d ts:%lld last pending\n",
-					crtc->base.id,
-					ktime_to_ns(fevent->ts));
-			SDE_EVT32(DRMID(crtc), fevent->event,
-							SDE_EVTLOG_FUNC_CASE2);
-			sde_core_perf_crtc_release_bw(crtc);
 		} else {
-			SDE_EVT32_VERBOSE(DRMID(crtc), fevent->event,
-							SDE_EVTLOG_FUNC_CASE3);
+			kickoff_ts = _sde_crtc_lat_frame_done(sde_crtc);
+			if (fevent->event & SDE_ENCODER_FRAME_EVENT_DONE)
+				_sde_crtc_lat_record(sde_crtc,
+						SDE_CRTC_LAT_FRAME_DONE,
+						kickoff_ts, fevent->ts);
+
+			if (atomic_dec_return(&sde_crtc->frame_pending) == 0) {
+				/* release bandwidth and other resources */
+				SDE_DEBUG("crtc%d ts:%lld last pending\n",
+						crtc->base.id,
+						ktime_to_ns(fevent->ts));
+				SDE_EVT32(DRMID(crtc), fevent->event,
+						SDE_EVTLOG_FUNC_CASE2);
+				sde_core_perf_crtc_release_bw(crtc);
+			} else {
+				SDE_EVT32_VERBOSE(DRMID(crtc), fevent->event,
+						SDE_EVTLOG_FUNC_CASE3);
+			}
 		}
 	}
 
@@ -2535,11 +2754,14 @@ static void sde_crtc_frame_event_work(struct kthread_work *work)
 		SDE_ATRACE_END("signal_release_fence");
 	}
 
-	if (fevent->event & SDE_ENCODER_FRAME_EVENT_SIGNAL_RETIRE_FENCE)
+	if (fevent->event & SDE_ENCODER_FRAME_EVENT_SIGNAL_RETIRE_FENCE) {
 		/* this api should be called without spin_lock */
 		_sde_crtc_retire_event(fevent->connector, fevent->ts,
 				(fevent->event & SDE_ENCODER_FRAME_EVENT_ERROR)
 				? SDE_FENCE_SIGNAL_ERROR : SDE_FENCE_SIGNAL);
+		_sde_crtc_lat_record(sde_crtc, SDE_CRTC_LAT_RETIRE,
+				fevent->ts, ktime_get());
+	}
 
 	if (fevent->event & SDE_ENCODER_FRAME_EVENT_PANEL_DEAD)
 		SDE_ERROR("crtc%d ts:%lld received panel dead event\n",
@@ -3053,7 +3275,9 @@ err:
 static void _sde_crtc_wait_for_fences(struct drm_crtc *crtc)
 {
 	struct drm_plane *plane = NULL;
-	uint32_t wait_ms = 1;
+	void *fences[SDE_PSTATES_MAX];
+	void *fence;
+	uint32_t wait_ms = 1, count = 0;
 	ktime_t kt_end, kt_wait;
 	int rc = 0;
 
@@ -3069,16 +3293,37 @@ static void _sde_crtc_wait_for_fences(struct drm_crtc *crtc)
 		to_sde_crtc_state(crtc->state)->input_fence_timeout_ns);
 
 	/*
-	 * Wait for fences sequentially, as all of them need to be signalled
-	 * before we can proceed.
+	 * Wait for all fences at once, so the commit thread is woken up only
+	 * when the last of them signals instead of once per plane.
 	 *
-	 * Limit total wait time to INPUT_FENCE_TIMEOUT, but still call
-	 * sde_plane_wait_input_fence with wait_ms == 0 after the timeout so
-	 * that each plane can check its fence status and react appropriately
-	 * if its fence has timed out. Call input fence wait multiple times if
-	 * fence wait is interrupted due to interrupt call.
+	 * Limit total wait time to INPUT_FENCE_TIMEOUT, then still call
+	 * sde_plane_wait_input_fence for each plane so that each plane can
+	 * check its fence status and react appropriately if its fence has
+	 * timed out. Signaled fences return from it without sleeping, and if
+	 * the group wait couldn't be set up the planes are waited on one by
+	 * one. Call input fence wait multiple times if fence wait is
+	 * interrupted due to interrupt call.
 	 */
 	SDE_ATRACE_BEGIN("plane_wait_input_fence");
+	drm_atomic_crtc_for_each_plane(plane, crtc) {
+		fence = plane->state ?
+			to_sde_plane_state(plane->state)->input_fence : NULL;
+		if (fence && count < ARRAY_SIZE(fences))
+			fences[count++] = fence;
+	}
+
+	while (count) {
+		kt_wait = ktime_sub(kt_end, ktime_get());
+		if (ktime_compare(kt_wait, ktime_set(0, 0)) >= 0)
+			wait_ms = ktime_to_ms(kt_wait);
+		else
+			wait_ms = 0;
+
+		rc = sde_sync_wait_all(fences, count, wait_ms);
+		if (!wait_ms || rc != -ERESTARTSYS)
+			break;
+	}
+
 	drm_atomic_crtc_for_each_plane(plane, crtc) {
 		do {
 			kt_wait = ktime_sub(kt_end, ktime_get());
@@ -3370,6 +3615,7 @@ static void sde_crtc_atomic_flush(struct drm_crtc *crtc,
 	struct msm_drm_private *priv;
 	struct sde_crtc_state *cstate;
 	struct sde_kms *sde_kms;
+	ktime_t kt_start;
 	int i;
 
 	if (!crtc || !crtc->dev || !crtc->dev->dev_private) {
@@ -3442,7 +3688,10 @@ static void sde_crtc_atomic_flush(struct drm_crtc *crtc,
 	sde_core_perf_crtc_update_llcc(crtc);
 
 	/* wait for acquire fences before anything else is done */
+	kt_start = ktime_get();
 	_sde_crtc_wait_for_fences(crtc);
+	_sde_crtc_lat_record(sde_crtc, SDE_CRTC_LAT_FENCE_WAIT, kt_start,
+			ktime_get());
 
 	if (!cstate->rsc_update) {
 		drm_for_each_encoder_mask(encoder, dev,
@@ -3724,6 +3973,7 @@ void sde_crtc_commit_kickoff(struct drm_crtc *crtc,
 	unsigned long flags;
 	enum sde_crtc_idle_pc_state idle_pc_state;
 	struct sde_encoder_kickoff_params params = { 0 };
+	ktime_t kt_start;
 
 	if (!crtc) {
 		SDE_ERROR("invalid argument\n");
@@ -3749,6 +3999,7 @@ void sde_crtc_commit_kickoff(struct drm_crtc *crtc,
 		return;
 
 	SDE_ATRACE_BEGIN("crtc_commit");
+	kt_start = ktime_get();
 
 	idle_pc_state = sde_crtc_get_property(cstate, CRTC_PROP_IDLE_PC_STATE);
 
@@ -3800,6 +4051,7 @@ void sde_crtc_commit_kickoff(struct drm_crtc *crtc,
 		SDE_EVT32(DRMID(crtc), SDE_EVTLOG_FUNC_CASE2);
 	}
 	sde_crtc->play_count++;
+	sde_hw_reg_io_frame_done();
 
 	sde_vbif_clear_errors(sde_kms);
 
@@ -3815,6 +4067,7 @@ void sde_crtc_commit_kickoff(struct drm_crtc *crtc,
 		sde_encoder_kickoff(encoder, false, true);
 	}
 	sde_crtc->kickoff_in_progress = false;
+	_sde_crtc_lat_kickoff(sde_crtc, ktime_get());
 
 	/* store the event after frame trigger */
 	if (sde_crtc->event) {
@@ -3826,6 +4079,8 @@ void sde_crtc_commit_kickoff(struct drm_crtc *crtc,
 	}
 
 	_sde_crtc_schedule_idle_notify(crtc);
+	_sde_crtc_lat_record(sde_crtc, SDE_CRTC_LAT_KICKOFF, kt_start,
+			ktime_get());
 
 	SDE_ATRACE_END("crtc_commit");
 }
@@ -4193,6 +4448,7 @@ static void sde_crtc_disable(struct drm_crtc *crtc)
 		sde_core_perf_crtc_release_bw(crtc);
 		atomic_set(&sde_crtc->frame_pending, 0);
 	}
+	_sde_crtc_lat_frames_reset(sde_crtc);
 
 	spin_lock_irqsave(&sde_crtc->spin_lock, flags);
 	list_for_each_entry(node, &sde_crtc->user_event_list, list) {
@@ -4213,9 +4469,14 @@ static void sde_crtc_disable(struct drm_crtc *crtc)
 		}
 	}
 
-	/* avoid clk/bw downvote if cont-splash is enabled */
+	/*
+	 * avoid clk/bw downvote if cont-splash is enabled, the crtc then only
+	 * leaves the bandwidth totals the other crtcs vote
+	 */
 	if (!in_cont_splash)
 		sde_core_perf_crtc_update(crtc, 0, true);
+	else
+		sde_core_perf_crtc_clear_perf(crtc);
 
 	drm_for_each_encoder_mask(encoder, crtc->dev,
 			crtc->state->encoder_mask) {
@@ -5002,6 +5263,7 @@ static int sde_crtc_atomic_check(struct drm_crtc *crtc,
 	struct sde_multirect_plane_states *multirect_plane = NULL;
 	struct drm_connector *conn;
 	struct drm_connector_list_iter conn_iter;
+	ktime_t kt_start = ktime_get();
 
 	if (!crtc) {
 		SDE_ERROR("invalid crtc\n");
@@ -5091,6 +5353,10 @@ static int sde_crtc_atomic_check(struct drm_crtc *crtc,
 				crtc->base.id, rc);
 		goto end;
 	}
+
+	/* only full checks are sampled, skipped and failed ones are short */
+	_sde_crtc_lat_record(sde_crtc, SDE_CRTC_LAT_ATOMIC_CHECK, kt_start,
+			ktime_get());
 end:
 	kfree(pstates);
 	kfree(multirect_plane);
@@ -6276,6 +6542,13 @@ static int _sde_crtc_init_debugfs(struct drm_crtc *crtc)
 		.open =		_sde_debugfs_fence_status,
 		.read =		seq_read,
 	};
+	static const struct file_operations debugfs_latency_fops = {
+		.open =		_sde_debugfs_latency_open,
+		.read =		seq_read,
+		.write =	_sde_debugfs_latency_write,
+		.llseek =	seq_lseek,
+		.release =	single_release,
+	};
 
 	if (!crtc)
 		return -EINVAL;
@@ -6304,6 +6577,8 @@ static int _sde_crtc_init_debugfs(struct drm_crtc *crtc)
 					sde_crtc, &debugfs_fps_fops);
 	debugfs_create_file("fence_status", 0400, sde_crtc->debugfs_root,
 					sde_crtc, &debugfs_fence_fops);
+	debugfs_create_file("commit_latency", 0600, sde_crtc->debugfs_root,
+					sde_crtc, &debugfs_latency_fops);
 
 	return 0;
 }
@@ -6641,6 +6916,7 @@ struct drm_crtc *sde_crtc_init(struct drm_device *dev, struct drm_plane *plane)
 	mutex_init(&sde_crtc->crtc_lock);
 	spin_lock_init(&sde_crtc->spin_lock);
 	spin_lock_init(&sde_crtc->fevent_spin_lock);
+	spin_lock_init(&sde_crtc->lat_hist.lock);
 	atomic_set(&sde_crtc->frame_pending, 0);
 
 	sde_crtc->enabled = false;
@@ -6797,7 +7073,6 @@ static int _sde_crtc_event_enable(struct sde_kms *kms,
 			if (!node)
 				return -ENOMEM;
 			INIT_LIST_HEAD(&node->list);
-			INIT_LIST_HEAD(&node->irq.list);
 			node->func = custom_events[i].func;
 			node->event = event;
 			node->state = IRQ_NOINIT;
@@ -6820,8 +7095,6 @@ static int _sde_crtc_event_enable(struct sde_kms *kms,
 			return ret;
 		}
 
-		INIT_LIST_HEAD(&node->irq.list);
-
 		mutex_lock(&crtc->crtc_lock);
 		ret = node->func(crtc_drm, true, &node->irq);
 		if (!ret) {
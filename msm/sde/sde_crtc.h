@@ -35,20 +35,6 @@
 /* Expand it to 2x for handling atleast 2 connectors safely */
 #define SDE_CRTC_FRAME_EVENT_SIZE	(4 * 2)
 
-/**
- * enum sde_crtc_client_type: crtc client type
- * @RT_CLIENT:	RealTime client like video/cmd mode display
- *              voting through apps rsc
- * @NRT_CLIENT:	Non-RealTime client like WB display
- *              voting through apps rsc
- * @RT_RSC_CLIENT:	Realtime display RSC voting client
- */
-enum sde_crtc_client_type {
-	RT_CLIENT,
-	NRT_CLIENT,
-	RT_RSC_CLIENT,
-};
-
 /**
  * enum sde_crtc_output_capture_point
  * @MIXER_OUT : capture mixer output
@@ -184,6 +170,51 @@ struct sde_crtc_fps_info {
 	u32 next_time_index;
 };
 
+/**
+ * enum sde_crtc_lat_stage - commit stages tracked by the latency histograms
+ * @SDE_CRTC_LAT_ATOMIC_CHECK: duration of a crtc atomic check that ran in full
+ * @SDE_CRTC_LAT_FENCE_WAIT: time spent waiting for the input fences
+ * @SDE_CRTC_LAT_KICKOFF: duration of the commit kickoff
+ * @SDE_CRTC_LAT_FRAME_DONE: end of the kickoff to the frame done event
+ * @SDE_CRTC_LAT_RETIRE: frame done event to retire fence signal
+ */
+enum sde_crtc_lat_stage {
+	SDE_CRTC_LAT_ATOMIC_CHECK,
+	SDE_CRTC_LAT_FENCE_WAIT,
+	SDE_CRTC_LAT_KICKOFF,
+	SDE_CRTC_LAT_FRAME_DONE,
+	SDE_CRTC_LAT_RETIRE,
+	SDE_CRTC_LAT_MAX,
+};
+
+/* bucket 0 counts samples below 1us, bucket n samples in [2^(n-1), 2^n) us */
+#define SDE_CRTC_LAT_BUCKETS 24
+
+/* kickoff timestamps kept for frames still pending, power of two */
+#define SDE_CRTC_LAT_FRAMES 4
+
+/**
+ * struct sde_crtc_lat_hist - log2 latency histograms of the commit stages
+ * @lock: protects the histograms, updated from commit and event threads
+ * @kickoff_ts: ktime at the end of the kickoff of each pending frame
+ * @kickoff_head: number of kickoff timestamps pushed
+ * @kickoff_tail: number of kickoff timestamps consumed by a frame done
+ * @bucket: number of samples per stage and log2 microsecond bucket
+ * @count: number of samples per stage
+ * @total_us: sum of the samples per stage in microseconds
+ * @max_us: largest sample per stage in microseconds
+ */
+struct sde_crtc_lat_hist {
+	spinlock_t lock;
+	ktime_t kickoff_ts[SDE_CRTC_LAT_FRAMES];
+	u32 kickoff_head;
+	u32 kickoff_tail;
+	u32 bucket[SDE_CRTC_LAT_MAX][SDE_CRTC_LAT_BUCKETS];
+	u32 count[SDE_CRTC_LAT_MAX];
+	u64 total_us[SDE_CRTC_LAT_MAX];
+	u64 max_us[SDE_CRTC_LAT_MAX];
+};
+
 /**
  * struct sde_ltm_buffer - defines LTM buffer structure.
  * @fb: frm framebuffer for the buffer
@@ -245,6 +276,8 @@ struct sde_crtc_misr_info {
  * @vblank_cb_time  : ktime at vblank count reset
  * @vblank_last_cb_time  : ktime at last vblank notification
  * @retire_frame_event_time  : ktime at last retire frame event
+ * @fps_info      : frame rate measurement
+ * @lat_hist      : latency histograms of the commit stages
  * @sysfs_dev  : sysfs device node for crtc
  * @vsync_event_sf : vsync event notifier sysfs device
  * @retire_frame_event_sf :retire frame event notifier sysfs device
@@ -328,6 +361,7 @@ struct sde_crtc {
 	ktime_t vblank_last_cb_time;
 	ktime_t retire_frame_event_time;
 	struct sde_crtc_fps_info fps_info;
+	struct sde_crtc_lat_hist lat_hist;
 	struct device *sysfs_dev;
 	struct kernfs_node *vsync_event_sf;
 	struct kernfs_node *retire_frame_event_sf;
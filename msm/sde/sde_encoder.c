@@ -1975,8 +1975,7 @@ static int _sde_encoder_rc_idle(struct drm_encoder *drm_enc,
 		_sde_encoder_resource_control_helper(drm_enc, false);
 
 		if (!sde_kms->perf.bw_vote_mode)
-			memset(&sde_crtc->cur_perf, 0,
-				sizeof(struct sde_core_perf_params));
+			sde_core_perf_crtc_clear_perf(crtc);
 	}
 
 	SDE_EVT32(DRMID(drm_enc), sw_event, sde_enc->rc_state,
@@ -1387,7 +1387,6 @@ struct sde_encoder_phys *sde_encoder_phys_vid_init(
 	phys_enc->comp_type = p->comp_type;
 	for (i = 0; i < INTR_IDX_MAX; i++) {
 		irq = &phys_enc->irq[i];
-		INIT_LIST_HEAD(&irq->cb.list);
 		irq->irq_idx = -EINVAL;
 		irq->hw_idx = -EINVAL;
 		irq->cb.arg = phys_enc;
@@ -1984,7 +1984,6 @@ struct sde_encoder_phys *sde_encoder_phys_wb_init(
 	init_waitqueue_head(&phys_enc->pending_kickoff_wq);
 
 	irq = &phys_enc->irq[INTR_IDX_WB_DONE];
-	INIT_LIST_HEAD(&irq->cb.list);
 	irq->name = "wb_done";
 	irq->hw_idx =  wb_enc->hw_wb->idx;
 	irq->irq_idx = -1;
@@ -1994,7 +1993,6 @@ struct sde_encoder_phys *sde_encoder_phys_wb_init(
 	irq->cb.func = sde_encoder_phys_wb_done_irq;
 
 	irq = &phys_enc->irq[INTR_IDX_PP1_OVFL];
-	INIT_LIST_HEAD(&irq->cb.list);
 	irq->name = "pp1_overflow";
 	irq->hw_idx = CWB_1;
 	irq->irq_idx = -1;
@@ -2004,7 +2002,6 @@ struct sde_encoder_phys *sde_encoder_phys_wb_init(
 	irq->cb.func = sde_encoder_phys_cwb_ovflow;
 
 	irq = &phys_enc->irq[INTR_IDX_PP2_OVFL];
-	INIT_LIST_HEAD(&irq->cb.list);
 	irq->name = "pp2_overflow";
 	irq->hw_idx = CWB_2;
 	irq->irq_idx = -1;
@@ -2014,7 +2011,6 @@ struct sde_encoder_phys *sde_encoder_phys_wb_init(
 	irq->cb.func = sde_encoder_phys_cwb_ovflow;
 
 	irq = &phys_enc->irq[INTR_IDX_PP3_OVFL];
-	INIT_LIST_HEAD(&irq->cb.list);
 	irq->name = "pp3_overflow";
 	irq->hw_idx = CWB_3;
 	irq->irq_idx = -1;
@@ -2024,7 +2020,6 @@ struct sde_encoder_phys *sde_encoder_phys_wb_init(
 	irq->cb.func = sde_encoder_phys_cwb_ovflow;
 
 	irq = &phys_enc->irq[INTR_IDX_PP4_OVFL];
-	INIT_LIST_HEAD(&irq->cb.list);
 	irq->name = "pp4_overflow";
 	irq->hw_idx = CWB_4;
 	irq->irq_idx = -1;
@@ -2034,7 +2029,6 @@ struct sde_encoder_phys *sde_encoder_phys_wb_init(
 	irq->cb.func = sde_encoder_phys_cwb_ovflow;
 
 	irq = &phys_enc->irq[INTR_IDX_PP5_OVFL];
-	INIT_LIST_HEAD(&irq->cb.list);
 	irq->name = "pp5_overflow";
 	irq->hw_idx = CWB_5;
 	irq->irq_idx = -1;
@@ -6,6 +6,7 @@
 #define pr_fmt(fmt)	"[drm:%s:%d] " fmt, __func__, __LINE__
 #include <linux/sync_file.h>
 #include <linux/dma-fence.h>
+#include <linux/completion.h>
 #include "msm_drv.h"
 #include "sde_kms.h"
 #include "sde_fence.h"
@@ -54,6 +55,74 @@ signed long sde_sync_wait(void *fnc, long timeout_ms)
 	return rc;
 }
 
+/**
+ * struct sde_sync_wait_cb - callback tracking one fence of a group wait
+ * @base: dma fence callback
+ * @pending: number of fences of the group not yet signaled
+ * @done: completion of the group wait
+ */
+struct sde_sync_wait_cb {
+	struct dma_fence_cb base;
+	atomic_t *pending;
+	struct completion *done;
+};
+
+static void _sde_sync_wait_cb(struct dma_fence *fence, struct dma_fence_cb *cb)
+{
+	struct sde_sync_wait_cb *wcb =
+			container_of(cb, struct sde_sync_wait_cb, base);
+
+	if (atomic_dec_and_test(wcb->pending))
+		complete(wcb->done);
+}
+
+signed long sde_sync_wait_all(void **fnc, u32 count, long timeout_ms)
+{
+	struct sde_sync_wait_cb *cbs;
+	DECLARE_COMPLETION_ONSTACK(done);
+	atomic_t pending;
+	signed long rc;
+	u32 i;
+
+	if (!fnc || !count)
+		return -EINVAL;
+
+	cbs = kcalloc(count, sizeof(*cbs), GFP_KERNEL);
+	if (!cbs)
+		return -ENOMEM;
+
+	/* hold one count so the completion can't fire while registering */
+	atomic_set(&pending, 1);
+	for (i = 0; i < count; i++) {
+		if (!fnc[i])
+			continue;
+
+		cbs[i].pending = &pending;
+		cbs[i].done = &done;
+		atomic_inc(&pending);
+		if (dma_fence_add_callback(fnc[i], &cbs[i].base,
+				_sde_sync_wait_cb)) {
+			/* already signaled */
+			atomic_dec(&pending);
+			cbs[i].pending = NULL;
+		}
+	}
+
+	if (atomic_dec_and_test(&pending))
+		rc = timeout_ms ? msecs_to_jiffies(timeout_ms) : 1;
+	else
+		rc = wait_for_completion_interruptible_timeout(&done,
+				timeout_ms < 0 ? MAX_SCHEDULE_TIMEOUT :
+				msecs_to_jiffies(timeout_ms));
+
+	for (i = 0; i < count; i++)
+		if (cbs[i].pending)
+			dma_fence_remove_callback(fnc[i], &cbs[i].base);
+	kfree(cbs);
+
+	return rc;
+}
+
 uint32_t sde_sync_get_name_prefix(void *fence)
 {
 	const char *name;
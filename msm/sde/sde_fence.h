@@ -87,6 +87,21 @@ void sde_sync_put(void *fence);
  */
 signed long sde_sync_wait(void *fence, long timeout_ms);
 
+/**
+ * sde_sync_wait_all - Wait for a group of sync fences with one wake-up
+ *
+ * @fences: Array of sync fences, NULL entries are skipped
+ * @count: Number of entries in @fences
+ * @timeout_ms: Time to wait, in milliseconds. Waits forever if timeout_ms < 0
+ *
+ * Return:
+ * Zero if timed out
+ * -ERESTARTSYS if wait interrupted
+ * -ENOMEM or -EINVAL if the group wait could not be set up
+ * remaining jiffies in all other success cases.
+ */
+signed long sde_sync_wait_all(void **fences, u32 count, long timeout_ms);
+
 /**
  * sde_sync_get_name_prefix - get integer representation of fence name prefix
  * @fence: Pointer to opaque fence structure
@@ -175,6 +190,12 @@ static inline signed long sde_sync_wait(void *fence, long timeout_ms)
 	return 0;
 }
 
+static inline signed long sde_sync_wait_all(void **fences, u32 count,
+		long timeout_ms)
+{
+	return 0;
+}
+
 static inline uint32_t sde_sync_get_name_prefix(void *fence)
 {
 	return 0x0;
@@ -0,0 +1,120 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#ifndef __SDE_FORMAT_HASH_H__
+#define __SDE_FORMAT_HASH_H__
+
+#include <linux/hash.h>
+#include <linux/types.h>
+
+#define SDE_FORMAT_HASH_BITS	8
+#define SDE_FORMAT_HASH_SIZE	(1 << SDE_FORMAT_HASH_BITS)
+
+/**
+ * struct sde_format_hash_slot - one slot of a format hash
+ * @modifier: format modifier of the entry
+ * @fourcc:   pixel format of the entry
+ * @entry:    format entry, NULL if the slot is free
+ */
+struct sde_format_hash_slot {
+	u64 modifier;
+	u32 fourcc;
+	const void *entry;
+};
+
+/**
+ * struct sde_format_hash - open addressed hash of format entries, keyed on
+ *	the pixel format and the format modifier
+ * @slot:  slots, probed linearly from the hash of the key
+ * @count: number of entries in the hash
+ * @ready: set once every entry is added, lookups must not use it before
+ */
+struct sde_format_hash {
+	struct sde_format_hash_slot slot[SDE_FORMAT_HASH_SIZE];
+	u32 count;
+	bool ready;
+};
+
+static inline u32 sde_format_hash_pos(u32 fourcc, u64 modifier)
+{
+	return hash_64(modifier ^ ((u64)fourcc << 32), SDE_FORMAT_HASH_BITS);
+}
+
+/**
+ * sde_format_hash_add - add an entry to a format hash, an entry already
+ *	added with the same key is kept
+ * @hash:     format hash
+ * @fourcc:   pixel format of the entry
+ * @modifier: format modifier of the entry
+ * @entry:    format entry
+ * Return: 0 on success, -ENOSPC if the hash is full
+ */
+static inline int sde_format_hash_add(struct sde_format_hash *hash,
+		u32 fourcc, u64 modifier, const void *entry)
+{
+	u32 pos = sde_format_hash_pos(fourcc, modifier);
+	struct sde_format_hash_slot *slot = &hash->slot[pos];
+
+	while (slot->entry) {
+		if (slot->fourcc == fourcc && slot->modifier == modifier)
+			return 0;
+		pos = (pos + 1) & (SDE_FORMAT_HASH_SIZE - 1);
+		slot = &hash->slot[pos];
+	}
+
+	/* keep a free slot so probing always ends */
+	if (hash->count >= SDE_FORMAT_HASH_SIZE - 1)
+		return -ENOSPC;
+
+	slot->modifier = modifier;
+	slot->fourcc = fourcc;
+	slot->entry = entry;
+	hash->count++;
+
+	return 0;
+}
+
+/**
+ * sde_format_hash_set_ready - publish a format hash once it is built
+ * @hash: format hash
+ */
+static inline void sde_format_hash_set_ready(struct sde_format_hash *hash)
+{
+	smp_store_release(&hash->ready, true);
+}
+
+/**
+ * sde_format_hash_is_ready - check whether a format hash can be used
+ * @hash: format hash
+ */
+static inline bool sde_format_hash_is_ready(const struct sde_format_hash *hash)
+{
+	return smp_load_acquire(&hash->ready);
+}
+
+/**
+ * sde_format_hash_find - look up the entry of a key in a ready format hash
+ * @hash:     format hash
+ * @fourcc:   pixel format to look up
+ * @modifier: format modifier to look up
+ * Return: format entry, NULL if the key is not in the hash
+ */
+static inline const void *sde_format_hash_find(
+		const struct sde_format_hash *hash, u32 fourcc, u64 modifier)
+{
+	u32 pos = sde_format_hash_pos(fourcc, modifier);
+	const struct sde_format_hash_slot *slot = &hash->slot[pos];
+
+	while (slot->entry) {
+		if (slot->fourcc == fourcc && slot->modifier == modifier)
+			return slot->entry;
+		pos = (pos + 1) & (SDE_FORMAT_HASH_SIZE - 1);
+		slot = &hash->slot[pos];
+	}
+
+	return NULL;
+}
+
+#endif /* __SDE_FORMAT_HASH_H__ */
@@ -10,6 +10,7 @@
 
 #include "sde_kms.h"
 #include "sde_formats.h"
+#include "sde_format_hash.h"
 
 #define SDE_UBWC_META_MACRO_W_H		16
 #define SDE_UBWC_META_BLOCK_SIZE	256
@@ -642,6 +643,108 @@ static const struct sde_format sde_format_map_tp10_ubwc[] = {
 		SDE_FETCH_UBWC, 4, SDE_TILE_HEIGHT_NV12),
 };
 
+/*
+ * Format maps per modifier. All maps share one hash keyed on the pixel
+ * format and the modifier of their map, built by sde_format_init_hash().
+ * Lookups walk the map of the modifier until then.
+ */
+enum sde_format_map_id {
+	SDE_FORMAT_MAP_LINEAR,
+	SDE_FORMAT_MAP_UBWC,
+	SDE_FORMAT_MAP_P010,
+	SDE_FORMAT_MAP_P010_UBWC,
+	SDE_FORMAT_MAP_TP10_UBWC,
+	SDE_FORMAT_MAP_TILE,
+	SDE_FORMAT_MAP_P010_TILE,
+	SDE_FORMAT_MAP_TP10_TILE,
+	SDE_FORMAT_MAP_MAX
+};
+
+/**
+ * struct sde_format_map_info - format map of a modifier
+ * @map: format map
+ * @count: number of entries in map
+ * @modifier: modifier the entries of the map are hashed with
+ */
+struct sde_format_map_info {
+	const struct sde_format *map;
+	u32 count;
+	u64 modifier;
+};
+
+#define SDE_FORMAT_MAP(m, mod) \
+	{ .map = m, .count = ARRAY_SIZE(m), .modifier = mod }
+
+static const struct sde_format_map_info sde_format_maps[SDE_FORMAT_MAP_MAX] = {
+	[SDE_FORMAT_MAP_LINEAR] = SDE_FORMAT_MAP(sde_format_map, 0),
+	[SDE_FORMAT_MAP_UBWC] = SDE_FORMAT_MAP(sde_format_map_ubwc,
+			DRM_FORMAT_MOD_QCOM_COMPRESSED),
+	[SDE_FORMAT_MAP_P010] = SDE_FORMAT_MAP(sde_format_map_p010,
+			DRM_FORMAT_MOD_QCOM_DX),
+	[SDE_FORMAT_MAP_P010_UBWC] = SDE_FORMAT_MAP(sde_format_map_p010_ubwc,
+			DRM_FORMAT_MOD_QCOM_DX | DRM_FORMAT_MOD_QCOM_COMPRESSED),
+	[SDE_FORMAT_MAP_TP10_UBWC] = SDE_FORMAT_MAP(sde_format_map_tp10_ubwc,
+			DRM_FORMAT_MOD_QCOM_DX | DRM_FORMAT_MOD_QCOM_COMPRESSED |
+			DRM_FORMAT_MOD_QCOM_TIGHT),
+	[SDE_FORMAT_MAP_TILE] = SDE_FORMAT_MAP(sde_format_map_tile,
+			DRM_FORMAT_MOD_QCOM_TILE),
+	[SDE_FORMAT_MAP_P010_TILE] = SDE_FORMAT_MAP(sde_format_map_p010_tile,
+			DRM_FORMAT_MOD_QCOM_TILE | DRM_FORMAT_MOD_QCOM_DX),
+	[SDE_FORMAT_MAP_TP10_TILE] = SDE_FORMAT_MAP(sde_format_map_tp10_tile,
+			DRM_FORMAT_MOD_QCOM_TILE | DRM_FORMAT_MOD_QCOM_DX |
+			DRM_FORMAT_MOD_QCOM_TIGHT),
+};
+
+static struct sde_format_hash sde_formats_hash;
+
+void sde_format_init_hash(void)
+{
+	const struct sde_format_map_info *info;
+	u32 i, j;
+
+	if (sde_format_hash_is_ready(&sde_formats_hash))
+		return;
+
+	for (i = 0; i < SDE_FORMAT_MAP_MAX; i++) {
+		info = &sde_format_maps[i];
+
+		/* the first entry of a duplicated format wins */
+		for (j = 0; j < info->count; j++) {
+			if (sde_format_hash_add(&sde_formats_hash,
+					info->map[j].base.pixel_format,
+					info->modifier, &info->map[j])) {
+				SDE_ERROR("format hash full, %u entries\n",
+						sde_formats_hash.count);
+				return;
+			}
+		}
+	}
+
+	sde_format_hash_set_ready(&sde_formats_hash);
+}
+
+static const struct sde_format *_sde_format_find_linear(
+		const struct sde_format_map_info *info, uint32_t pixel_format)
+{
+	u32 i;
+
+	for (i = 0; i < info->count; i++)
+		if (info->map[i].base.pixel_format == pixel_format)
+			return &info->map[i];
+
+	return NULL;
+}
+
+static const struct sde_format *_sde_format_find(
+		const struct sde_format_map_info *info, uint32_t pixel_format)
+{
+	if (!sde_format_hash_is_ready(&sde_formats_hash))
+		return _sde_format_find_linear(info, pixel_format);
+
+	return sde_format_hash_find(&sde_formats_hash, pixel_format,
+			info->modifier);
+}
+
 bool sde_format_is_tp10_ubwc(const struct sde_format *fmt)
 {
 	if (SDE_FORMAT_IS_YUV(fmt) && SDE_FORMAT_IS_DX(fmt) &&
@@ -1157,14 +1260,12 @@ int sde_format_check_modified_format(
 	return 0;
 }
 
-const struct sde_format *sde_get_sde_format_ext(
+/* returns the format map of the modifier, NULL if it is not supported */
+static const struct sde_format_map_info *_sde_format_get_map(
 		const uint32_t format,
 		const uint64_t modifier)
 {
-	uint32_t i = 0;
-	const struct sde_format *fmt = NULL;
-	const struct sde_format *map = NULL;
-	ssize_t map_size = 0;
+	enum sde_format_map_id map_id;
 
 	/*
 	 * Currently only support exactly zero or one modifier.
@@ -1174,27 +1275,23 @@ const struct sde_format *sde_get_sde_format_ext(
 
 	switch (modifier) {
 	case 0:
-		map = sde_format_map;
-		map_size = ARRAY_SIZE(sde_format_map);
+		map_id = SDE_FORMAT_MAP_LINEAR;
 		break;
 	case DRM_FORMAT_MOD_QCOM_COMPRESSED:
 	case DRM_FORMAT_MOD_QCOM_COMPRESSED | DRM_FORMAT_MOD_QCOM_TILE:
-		map = sde_format_map_ubwc;
-		map_size = ARRAY_SIZE(sde_format_map_ubwc);
+		map_id = SDE_FORMAT_MAP_UBWC;
 		SDE_DEBUG("found fmt: %4.4s  DRM_FORMAT_MOD_QCOM_COMPRESSED\n",
 				(char *)&format);
 		break;
 	case DRM_FORMAT_MOD_QCOM_DX:
-		map = sde_format_map_p010;
-		map_size = ARRAY_SIZE(sde_format_map_p010);
+		map_id = SDE_FORMAT_MAP_P010;
 		SDE_DEBUG("found fmt: %4.4s DRM_FORMAT_MOD_QCOM_DX\n",
 				(char *)&format);
 		break;
 	case (DRM_FORMAT_MOD_QCOM_DX | DRM_FORMAT_MOD_QCOM_COMPRESSED):
 	case (DRM_FORMAT_MOD_QCOM_DX | DRM_FORMAT_MOD_QCOM_COMPRESSED |
 			DRM_FORMAT_MOD_QCOM_TILE):
-		map = sde_format_map_p010_ubwc;
-		map_size = ARRAY_SIZE(sde_format_map_p010_ubwc);
+		map_id = SDE_FORMAT_MAP_P010_UBWC;
 		SDE_DEBUG(
 			"found fmt: %4.4s DRM_FORMAT_MOD_QCOM_COMPRESSED/DX\n",
 				(char *)&format);
@@ -1203,28 +1300,24 @@ const struct sde_format *sde_get_sde_format_ext(
 		DRM_FORMAT_MOD_QCOM_TIGHT):
 	case (DRM_FORMAT_MOD_QCOM_DX | DRM_FORMAT_MOD_QCOM_COMPRESSED |
 		DRM_FORMAT_MOD_QCOM_TIGHT | DRM_FORMAT_MOD_QCOM_TILE):
-		map = sde_format_map_tp10_ubwc;
-		map_size = ARRAY_SIZE(sde_format_map_tp10_ubwc);
+		map_id = SDE_FORMAT_MAP_TP10_UBWC;
 		SDE_DEBUG(
 			"found fmt: %4.4s DRM_FORMAT_MOD_QCOM_COMPRESSED/DX/TIGHT\n",
 				(char *)&format);
 		break;
 	case DRM_FORMAT_MOD_QCOM_TILE:
-		map = sde_format_map_tile;
-		map_size = ARRAY_SIZE(sde_format_map_tile);
+		map_id = SDE_FORMAT_MAP_TILE;
 		SDE_DEBUG("found fmt: %4.4s DRM_FORMAT_MOD_QCOM_TILE\n",
 				(char *)&format);
 		break;
 	case (DRM_FORMAT_MOD_QCOM_TILE | DRM_FORMAT_MOD_QCOM_DX):
-		map = sde_format_map_p010_tile;
-		map_size = ARRAY_SIZE(sde_format_map_p010_tile);
+		map_id = SDE_FORMAT_MAP_P010_TILE;
 		SDE_DEBUG("found fmt: %4.4s DRM_FORMAT_MOD_QCOM_TILE/DX\n",
 				(char *)&format);
 		break;
 	case (DRM_FORMAT_MOD_QCOM_TILE | DRM_FORMAT_MOD_QCOM_DX |
 			DRM_FORMAT_MOD_QCOM_TIGHT):
-		map = sde_format_map_tp10_tile;
-		map_size = ARRAY_SIZE(sde_format_map_tp10_tile);
+		map_id = SDE_FORMAT_MAP_TP10_TILE;
 		SDE_DEBUG(
 			"found fmt: %4.4s DRM_FORMAT_MOD_QCOM_TILE/DX/TIGHT\n",
 				(char *)&format);
@@ -1234,12 +1327,34 @@ const struct sde_format *sde_get_sde_format_ext(
 		return NULL;
 	}
 
-	for (i = 0; i < map_size; i++) {
-		if (format == map[i].base.pixel_format) {
-			fmt = &map[i];
-			break;
-		}
-	}
+	return &sde_format_maps[map_id];
+}
+
+#ifdef CONFIG_DRM_MSM_SDE_KUNIT_TEST
+const struct sde_format *sde_get_sde_format_linear(
+		const uint32_t format,
+		const uint64_t modifier)
+{
+	const struct sde_format_map_info *info;
+
+	info = _sde_format_get_map(format, modifier);
+
+	return info ? _sde_format_find_linear(info, format) : NULL;
+}
+#endif
+
+const struct sde_format *sde_get_sde_format_ext(
+		const uint32_t format,
+		const uint64_t modifier)
+{
+	const struct sde_format_map_info *info;
+	const struct sde_format *fmt;
+
+	info = _sde_format_get_map(format, modifier);
+	if (!info)
+		return NULL;
+
+	fmt = _sde_format_find(info, format);
 
 	if (fmt == NULL)
 		SDE_ERROR("unsupported fmt: %4.4s modifier 0x%llX\n",
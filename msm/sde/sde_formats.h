@@ -21,6 +21,24 @@ const struct sde_format *sde_get_sde_format_ext(
 
 #define sde_get_sde_format(f) sde_get_sde_format_ext(f, 0)
 
+/**
+ * sde_format_init_hash() - Builds the format lookup hash, lookups walk
+ *                          the format maps until then.
+ */
+void sde_format_init_hash(void);
+
+#ifdef CONFIG_DRM_MSM_SDE_KUNIT_TEST
+/**
+ * sde_get_sde_format_linear() - Returns sde format structure pointer found
+ *                               by walking the format map, for tests.
+ * @format:          DRM FourCC Code
+ * @modifier:        format modifier from client
+ */
+const struct sde_format *sde_get_sde_format_linear(
+		const uint32_t format,
+		const uint64_t modifier);
+#endif
+
 /**
  * sde_get_msm_format - get an sde_format by its msm_format base
  *                     callback function registers with the msm_kms layer
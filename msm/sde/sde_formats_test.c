@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#include <kunit/test.h>
+#include <linux/ktime.h>
+
+#include "sde_formats.h"
+#include "sde_hw_catalog.h"
+#include "sde_hw_catalog_format.h"
+#include "sde_kunit.h"
+
+#define SDE_FORMATS_TEST_ROUNDS	1000
+
+/* format lists of the catalog, each ends with a zero format */
+static const struct sde_format_extended *sde_formats_test_lists[] = {
+	plane_formats,
+	plane_formats_vig,
+	cursor_formats,
+	wb2_formats,
+	true_inline_rot_v2_fmts,
+};
+
+static void sde_formats_test_lookup(struct kunit *test)
+{
+	const struct sde_format_extended *list;
+	u32 i, j;
+
+	sde_format_init_hash();
+
+	for (i = 0; i < ARRAY_SIZE(sde_formats_test_lists); i++) {
+		for (list = sde_formats_test_lists[i], j = 0;
+				list[j].fourcc_format; j++) {
+			const struct sde_format *fmt;
+
+			fmt = sde_get_sde_format_ext(list[j].fourcc_format,
+					list[j].modifier);
+			KUNIT_EXPECT_NOT_ERR_OR_NULL(test, fmt);
+			KUNIT_EXPECT_PTR_EQ_MSG(test, fmt,
+				sde_get_sde_format_linear(list[j].fourcc_format,
+					list[j].modifier),
+				"fmt %4.4s mod 0x%llx",
+				(char *)&list[j].fourcc_format,
+				list[j].modifier);
+		}
+	}
+
+	/* the p010 ubwc list has no zero format at its end */
+	KUNIT_EXPECT_PTR_EQ(test,
+			sde_get_sde_format_ext(p010_ubwc_formats[0].fourcc_format,
+				p010_ubwc_formats[0].modifier),
+			sde_get_sde_format_linear(
+				p010_ubwc_formats[0].fourcc_format,
+				p010_ubwc_formats[0].modifier));
+
+	/* formats missing from a map are not found through the hash either */
+	KUNIT_EXPECT_PTR_EQ(test, NULL,
+			sde_get_sde_format_ext(DRM_FORMAT_C8, 0));
+	KUNIT_EXPECT_PTR_EQ(test, NULL,
+			sde_get_sde_format_ext(DRM_FORMAT_RGB565,
+				DRM_FORMAT_MOD_QCOM_DX));
+}
+
+static u64 sde_formats_test_time(const struct sde_format *(*lookup)(
+		const uint32_t, const uint64_t))
+{
+	const struct sde_format_extended *list = plane_formats_vig;
+	u64 start_ns;
+	u32 i, j;
+
+	start_ns = ktime_get_ns();
+	for (i = 0; i < SDE_FORMATS_TEST_ROUNDS; i++)
+		for (j = 0; list[j].fourcc_format; j++)
+			lookup(list[j].fourcc_format, list[j].modifier);
+
+	return ktime_get_ns() - start_ns;
+}
+
+/* times a lookup of every vig plane format against the map walk */
+static void sde_formats_test_bench(struct kunit *test)
+{
+	u64 linear_ns, hash_ns;
+
+	sde_format_init_hash();
+
+	linear_ns = sde_formats_test_time(sde_get_sde_format_linear);
+	hash_ns = sde_formats_test_time(sde_get_sde_format_ext);
+
+	kunit_info(test, "ns per format list: linear:%llu hash:%llu\n",
+			div_u64(linear_ns, SDE_FORMATS_TEST_ROUNDS),
+			div_u64(hash_ns, SDE_FORMATS_TEST_ROUNDS));
+	KUNIT_EXPECT_LT(test, hash_ns, linear_ns);
+}
+
+static struct kunit_case sde_formats_test_cases[] = {
+	KUNIT_CASE(sde_formats_test_lookup),
+	KUNIT_CASE(sde_formats_test_bench),
+	{}
+};
+
+struct kunit_suite sde_formats_test_suite = {
+	.name = "sde_formats",
+	.test_cases = sde_formats_test_cases,
+};
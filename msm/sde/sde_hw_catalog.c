@@ -204,6 +204,7 @@ enum sde_prop {
 	BASE_LAYER,
 	TRUSTED_VM_ENV,
 	MAX_TRUSTED_VM_DISPLAYS,
+	REG_SHADOW,
 	SDE_PROP_MAX,
 };
 
@@ -577,6 +578,7 @@ static struct sde_prop_type sde_prop[] = {
 	{TRUSTED_VM_ENV, "qcom,sde-trusted-vm-env", false, PROP_TYPE_BOOL},
 	{MAX_TRUSTED_VM_DISPLAYS, "qcom,sde-max-trusted-vm-displays", false,
 			PROP_TYPE_U32},
+	{REG_SHADOW, "qcom,sde-reg-shadow-cache", false, PROP_TYPE_BOOL},
 };
 
 static struct sde_prop_type sde_perf_prop[] = {
@@ -3813,6 +3815,7 @@ static void _sde_top_parse_dt_helper(struct sde_mdss_cfg *cfg,
 			 0);
 	cfg->max_trusted_vm_displays = PROP_VALUE_ACCESS(props->values,
 			MAX_TRUSTED_VM_DISPLAYS, 0);
+	cfg->has_reg_shadow = PROP_VALUE_ACCESS(props->values, REG_SHADOW, 0);
 }
 
 static int sde_top_parse_dt(struct device_node *np, struct sde_mdss_cfg *cfg)
@@ -4910,6 +4913,137 @@ static int _sde_hardware_pre_caps(struct sde_mdss_cfg *sde_cfg, uint32_t hw_rev)
 	return rc;
 }
 
+/*
+ * Registers that must always reach the hardware, either because writing them
+ * triggers an action (flush, start, reset, misr) or because the hardware
+ * updates them on its own (status, counters). Offsets are relative to the
+ * block base.
+ */
+static const struct sde_reg_range sde_sspp_volatile_regs[] = {
+	{0x070, 0x4},	/* SSPP_SRC_ADDR_SW_STATUS */
+	{0x138, 0x4},	/* SSPP_UBWC_ERROR_STATUS */
+	{0x1C0, 0x8},	/* SSPP_SBUF_STATUS_PLANE0/1 */
+};
+
+static const struct sde_reg_range sde_lm_volatile_regs[] = {
+	{0x310, 0x8},	/* LM_MISR_CTRL/SIGNATURE */
+};
+
+static const struct sde_reg_range sde_ctl_volatile_regs[] = {
+	{0x018, 0x8},	/* CTL_FLUSH, CTL_START */
+	{0x030, 0x4},	/* CTL_SW_RESET */
+	{0x060, 0x8},	/* CTL_SW_RESET_OVERRIDE, CTL_STATUS */
+	{0x0C4, 0x4},	/* CTL_ROT_FLUSH */
+	{0x0CC, 0xC},	/* CTL_ROT_START, CTL_PREPARE, LUTDMA SW trigger */
+	{0x100, 0x18},	/* CTL_MERGE_3D_FLUSH .. CTL_CDM_FLUSH */
+	{0x128, 0x4},	/* CTL_PERIPH_FLUSH */
+	{0x13C, 0x20},	/* CTL_DSPP_n_FLUSH */
+};
+
+static const struct sde_reg_range sde_intf_volatile_regs[] = {
+	{0x000, 0x4},	/* INTF_TIMING_ENGINE_EN */
+	{0x084, 0x4},	/* INTF_DSI_CMD_MODE_TRIGGER_EN */
+	{0x0A8, 0xC},	/* INTF_FRAME_LINE_COUNT_EN, FRAME/LINE_COUNT */
+	{0x180, 0x8},	/* INTF_MISR_CTRL/SIGNATURE */
+	{0x268, 0x8},	/* INTF_UNDERRUN_COUNT, INTF_STATUS */
+	{0x278, 0x4},	/* INTF_AVR_TRIGGER */
+	{0x290, 0x4},	/* INTF_TEAR_SYNC_WRCOUNT */
+	{0x298, 0x4},	/* INTF_TEAR_INT_COUNT_VAL */
+	{0x2AC, 0xC},	/* INTF_TEAR_OUT_LINE_COUNT .. AUTOREFRESH_CONFIG */
+};
+
+static void _sde_hw_add_sspp_volatile(struct sde_sspp_cfg *sspp,
+		u32 start, u32 len)
+{
+	struct sde_sspp_sub_blks *sblk = sspp->sblk;
+	u32 i = sblk->reg_shadow.volatile_count;
+
+	/* sub-blocks of unknown length are volatile up to the end of the pipe */
+	if (!len)
+		len = sspp->len > start ? sspp->len - start : 0;
+
+	if (!len || i >= SDE_SSPP_SHADOW_VOLATILE_MAX)
+		return;
+
+	sblk->shadow_volatile_regs[i].start = start;
+	sblk->shadow_volatile_regs[i].len = len;
+	sblk->reg_shadow.volatile_count++;
+}
+
+/*
+ * LUTDMA programs the scaler and the color sub-blocks of a pipe directly,
+ * so the values it writes never reach the cache of the pipe.
+ */
+static void _sde_hw_setup_sspp_reg_shadow(struct sde_mdss_cfg *sde_cfg,
+		struct sde_sspp_cfg *sspp)
+{
+	struct sde_sspp_sub_blks *sblk = sspp->sblk;
+	int i;
+
+	if (!sblk)
+		return;
+
+	sblk->reg_shadow.enable = true;
+	sblk->reg_shadow.volatile_regs = sblk->shadow_volatile_regs;
+	for (i = 0; i < ARRAY_SIZE(sde_sspp_volatile_regs); i++)
+		_sde_hw_add_sspp_volatile(sspp, sde_sspp_volatile_regs[i].start,
+				sde_sspp_volatile_regs[i].len);
+
+	if (!sde_cfg->reg_dma_count)
+		return;
+
+	if (test_bit(SDE_SSPP_SCALER_QSEED3, &sspp->features) ||
+			test_bit(SDE_SSPP_SCALER_QSEED3LITE, &sspp->features))
+		_sde_hw_add_sspp_volatile(sspp, sblk->scaler_blk.base,
+				sblk->scaler_blk.len);
+
+	if (test_bit(SDE_SSPP_VIG_GAMUT, &sspp->features))
+		_sde_hw_add_sspp_volatile(sspp, sblk->gamut_blk.base,
+				sblk->gamut_blk.len);
+
+	if (test_bit(SDE_SSPP_VIG_IGC, &sspp->features))
+		_sde_hw_add_sspp_volatile(sspp, sblk->igc_blk[0].base,
+				sblk->igc_blk[0].len);
+
+	if (test_bit(SDE_SSPP_DMA_IGC, &sspp->features))
+		for (i = 0; i < sblk->num_igc_blk; i++)
+			_sde_hw_add_sspp_volatile(sspp, sblk->igc_blk[i].base,
+					sblk->igc_blk[i].len);
+
+	if (test_bit(SDE_SSPP_DMA_GC, &sspp->features))
+		for (i = 0; i < sblk->num_gc_blk; i++)
+			_sde_hw_add_sspp_volatile(sspp, sblk->gc_blk[i].base,
+					sblk->gc_blk[i].len);
+}
+
+static void _sde_hw_setup_reg_shadow(struct sde_mdss_cfg *sde_cfg)
+{
+	struct sde_reg_shadow_cfg *shadow = sde_cfg->reg_shadow;
+	int i;
+
+	/* register contents are owned by the primary vm across handoffs */
+	if (!sde_cfg->has_reg_shadow || sde_cfg->trusted_vm_env)
+		return;
+
+	for (i = 0; i < sde_cfg->sspp_count; i++)
+		_sde_hw_setup_sspp_reg_shadow(sde_cfg, &sde_cfg->sspp[i]);
+
+	shadow[SDE_HW_BLK_LM].enable = true;
+	shadow[SDE_HW_BLK_LM].volatile_regs = sde_lm_volatile_regs;
+	shadow[SDE_HW_BLK_LM].volatile_count =
+			ARRAY_SIZE(sde_lm_volatile_regs);
+
+	shadow[SDE_HW_BLK_CTL].enable = true;
+	shadow[SDE_HW_BLK_CTL].volatile_regs = sde_ctl_volatile_regs;
+	shadow[SDE_HW_BLK_CTL].volatile_count =
+			ARRAY_SIZE(sde_ctl_volatile_regs);
+
+	shadow[SDE_HW_BLK_INTF].enable = true;
+	shadow[SDE_HW_BLK_INTF].volatile_regs = sde_intf_volatile_regs;
+	shadow[SDE_HW_BLK_INTF].volatile_count =
+			ARRAY_SIZE(sde_intf_volatile_regs);
+}
+
 static int _sde_hardware_post_caps(struct sde_mdss_cfg *sde_cfg,
 	uint32_t hw_rev)
 {
@@ -4959,6 +5093,8 @@ static int _sde_hardware_post_caps(struct sde_mdss_cfg *sde_cfg,
 	sde_cfg->min_display_height = MIN_DISPLAY_HEIGHT;
 	sde_cfg->min_display_width = MIN_DISPLAY_WIDTH;
 
+	_sde_hw_setup_reg_shadow(sde_cfg);
+
 	return rc;
 }
 
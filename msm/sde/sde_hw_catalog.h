@@ -681,6 +681,31 @@ enum sde_qos_lut_usage {
 	SDE_QOS_LUT_USAGE_MAX,
 };
 
+/**
+ * struct sde_reg_range - register range relative to a block base
+ * @start:  offset of the first register in the range
+ * @len:    length of the range in bytes
+ */
+struct sde_reg_range {
+	u32 start;
+	u32 len;
+};
+
+/**
+ * struct sde_reg_shadow_cfg - register write cache settings of a block
+ * @enable:         cache register writes and skip the redundant ones
+ * @volatile_regs:  register ranges that always bypass the cache
+ * @volatile_count: number of entries in volatile_regs
+ */
+struct sde_reg_shadow_cfg {
+	bool enable;
+	const struct sde_reg_range *volatile_regs;
+	u32 volatile_count;
+};
+
+/* volatile ranges of a pipe: the common ones and its LUTDMA sub-blocks */
+#define SDE_SSPP_SHADOW_VOLATILE_MAX	12
+
 /**
  * struct sde_sspp_sub_blks : SSPP sub-blocks
  * @maxlinewidth: max source pipe line width support
@@ -723,6 +748,9 @@ enum sde_qos_lut_usage {
  * @in_rot_maxheight: max pre rotated height for inline rotation
  * @llcc_scid: scid for the system cache
  * @llcc_slice size: slice size of the system cache
+ * @reg_shadow: register shadow cache settings of this pipe
+ * @shadow_volatile_regs: volatile ranges of this pipe, which include the
+ *                        sub-blocks programmed by LUTDMA behind the cache
  */
 struct sde_sspp_sub_blks {
 	u32 maxlinewidth;
@@ -762,6 +790,8 @@ struct sde_sspp_sub_blks {
 	u32 in_rot_maxheight;
 	int llcc_scid;
 	size_t llcc_slice_size;
+	struct sde_reg_shadow_cfg reg_shadow;
+	struct sde_reg_range shadow_volatile_regs[SDE_SSPP_SHADOW_VOLATILE_MAX];
 };
 
 /**
@@ -1462,6 +1492,9 @@ struct sde_perf_cfg {
  * @irq_offset_list     list of sde_intr_irq_offsets to initialize irq table
  * @rc_count	number of rounded corner hardware instances
  * @demura_count number of demura hardware instances
+ * @has_reg_shadow      skip redundant register writes using a shadow cache
+ * @reg_shadow          register shadow cache settings per hw block type,
+ *                      except for sspp, kept per pipe in the sub-blocks
  */
 struct sde_mdss_cfg {
 	u32 hwversion;
@@ -1609,6 +1642,9 @@ struct sde_mdss_cfg {
 	struct sde_format_extended *inline_rot_formats;
 
 	struct list_head irq_offset_list;
+
+	bool has_reg_shadow;
+	struct sde_reg_shadow_cfg reg_shadow[SDE_HW_BLK_MAX];
 };
 
 struct sde_mdss_hw_cfg_handler {
@@ -768,6 +768,7 @@ static int sde_hw_ctl_reset_control(struct sde_hw_ctl *ctx)
 	c = &ctx->hw;
 	pr_debug("issuing hw ctl reset for ctl:%d\n", ctx->idx);
 	SDE_REG_WRITE(c, CTL_SW_RESET, 0x1);
+	sde_hw_reg_shadow_invalidate_all();
 	if (sde_hw_ctl_poll_reset_status(ctx, SDE_REG_RESET_TIMEOUT_US))
 		return -EINVAL;
 
@@ -785,6 +786,7 @@ static void sde_hw_ctl_hard_reset(struct sde_hw_ctl *ctx, bool enable)
 	pr_debug("hw ctl hard reset for ctl:%d, %d\n",
 			ctx->idx - CTL_0, enable);
 	SDE_REG_WRITE(c, CTL_SW_RESET_OVERRIDE, enable);
+	sde_hw_reg_shadow_invalidate_all();
 }
 
 static int sde_hw_ctl_wait_reset_status(struct sde_hw_ctl *ctx)
@@ -1427,6 +1429,13 @@ struct sde_hw_ctl *sde_hw_ctl_init(enum sde_ctl idx,
 	c->mixer_count = m->mixer_count;
 	c->mixer_hw_caps = m->mixer;
 
+	rc = sde_hw_reg_shadow_init(&c->hw, cfg->name,
+			&m->reg_shadow[SDE_HW_BLK_CTL]);
+	if (rc) {
+		SDE_ERROR("failed to init reg shadow %d\n", rc);
+		goto blk_init_error;
+	}
+
 	rc = sde_hw_blk_init(&c->base, SDE_HW_BLK_CTL, idx, &sde_hw_ops);
 	if (rc) {
 		SDE_ERROR("failed to init hw blk %d\n", rc);
@@ -1439,6 +1448,7 @@ struct sde_hw_ctl *sde_hw_ctl_init(enum sde_ctl idx,
 	return c;
 
 blk_init_error:
+	sde_hw_reg_shadow_destroy(&c->hw);
 	kzfree(c);
 
 	return ERR_PTR(rc);
@@ -1446,7 +1456,9 @@ blk_init_error:
 
 void sde_hw_ctl_destroy(struct sde_hw_ctl *ctx)
 {
-	if (ctx)
+	if (ctx) {
 		sde_hw_blk_destroy(&ctx->base);
+		sde_hw_reg_shadow_destroy(&ctx->hw);
+	}
 	kfree(ctx);
 }
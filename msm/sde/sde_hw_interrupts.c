@@ -10,6 +10,7 @@
 #include "sde_hw_interrupts.h"
 #include "sde_hw_util.h"
 #include "sde_hw_mdss.h"
+#include "sde_trace.h"
 
 /**
  * Register offsets in MDSS register file for the interrupt registers
@@ -191,6 +192,9 @@
 #define SDE_INTR_LTM_STATS_DONE BIT(0)
 #define SDE_INTR_LTM_STATS_WB_PB BIT(5)
 
+/* instances at or above this index are not kept in the irq_idx lookup table */
+#define SDE_IRQ_LUT_MAX_INSTANCE	64
+
 /**
  * struct sde_intr_reg - array of SDE register sets
  * @clr_off:	offset to CLEAR reg
@@ -198,6 +202,8 @@
  * @status_off:	offset to STATUS reg
  * @map_idx_start   first offset in the sde_irq_map table
  * @map_idx_end    last offset in the sde_irq_map table
+ * @valid_mask:	status bits that map to an entry of the sde_irq_map table
+ * @bit_irq_idx:	sde_irq_map index serving each status bit, -1 if none
  */
 struct sde_intr_reg {
 	u32 clr_off;
@@ -205,6 +211,8 @@ struct sde_intr_reg {
 	u32 status_off;
 	u32 map_idx_start;
 	u32 map_idx_end;
+	u32 valid_mask;
+	s32 bit_irq_idx[32];
 };
 
 /**
@@ -425,12 +433,24 @@ static int sde_hw_intr_irqidx_lookup(struct sde_hw_intr *intr,
 {
 	int i;
 
+	if (intr_type < SDE_IRQ_TYPE_RESERVED &&
+			instance_idx < intr->irq_idx_lut_inst) {
+		i = intr->irq_idx_lut[intr_type * intr->irq_idx_lut_inst +
+				instance_idx];
+		if (i >= 0)
+			return i;
+
+		goto fail;
+	}
+
+	/* instances outside of the lookup table */
 	for (i = 0; i < intr->sde_irq_map_size; i++) {
 		if (intr_type == intr->sde_irq_map[i].intr_type &&
 			instance_idx == intr->sde_irq_map[i].instance_idx)
 			return i;
 	}
 
+fail:
 	pr_debug("IRQ lookup fail!! intr_type=%d, instance_idx=%d\n",
 			intr_type, instance_idx);
 	return -EINVAL;
@@ -454,14 +474,18 @@ static void sde_hw_intr_dispatch_irq(struct sde_hw_intr *intr,
 {
 	int reg_idx;
 	int irq_idx;
-	int start_idx;
-	int end_idx;
 	u32 irq_status;
+	u32 bit;
+	u64 start_ns = 0;
+	bool trace;
 	unsigned long irq_flags;
+	const struct sde_intr_reg *reg;
 
 	if (!intr)
 		return;
 
+	trace = trace_sde_irq_dispatch_enabled();
+
 	/*
 	 * The dispatcher will save the IRQ status before calling here.
 	 * Now need to go through each IRQ status and find matching
@@ -469,52 +493,42 @@ static void sde_hw_intr_dispatch_irq(struct sde_hw_intr *intr,
 	 */
 	spin_lock_irqsave(&intr->irq_lock, irq_flags);
 	for (reg_idx = 0; reg_idx < intr->sde_irq_size; reg_idx++) {
-		irq_status = intr->save_irq_status[reg_idx];
-
-		/*
-		 * Each Interrupt register has dynamic range of indexes,
-		 * initialized during hw_intr_init when sde_irq_tbl is created.
-		 */
-		start_idx = intr->sde_irq_tbl[reg_idx].map_idx_start;
-		end_idx = intr->sde_irq_tbl[reg_idx].map_idx_end;
-
-		if (start_idx >= intr->sde_irq_map_size ||
-				end_idx > intr->sde_irq_map_size)
+		reg = &intr->sde_irq_tbl[reg_idx];
+		irq_status = intr->save_irq_status[reg_idx] & reg->valid_mask;
+		if (!irq_status)
 			continue;
 
+		if (trace)
+			start_ns = ktime_get_ns();
+
 		/*
-		 * Search through matching intr status from irq map.
-		 * start_idx and end_idx defined the search range in
-		 * the sde_irq_map.
+		 * Only visit the set status bits; each bit maps directly to
+		 * its sde_irq_map index, precomputed during hw_intr_init.
 		 */
-		for (irq_idx = start_idx;
-				(irq_idx < end_idx) && irq_status;
-				irq_idx++)
-			if ((irq_status &
-				intr->sde_irq_map[irq_idx].irq_mask) &&
-				(intr->sde_irq_map[irq_idx].reg_idx ==
-				 reg_idx)) {
-				/*
-				 * Once a match on irq mask, perform a callback
-				 * to the given cbfunc. cbfunc will take care
-				 * the interrupt status clearing. If cbfunc is
-				 * not provided, then the interrupt clearing
-				 * is here.
-				 */
-				if (cbfunc)
-					cbfunc(arg, irq_idx);
-				else
-					intr->ops.clear_intr_status_nolock(
-							intr, irq_idx);
-
-				/*
-				 * When callback finish, clear the irq_status
-				 * with the matching mask. Once irq_status
-				 * is all cleared, the search can be stopped.
-				 */
-				irq_status &=
-					~intr->sde_irq_map[irq_idx].irq_mask;
-			}
+		while (irq_status) {
+			bit = __ffs(irq_status);
+			irq_idx = reg->bit_irq_idx[bit];
+
+			/*
+			 * Perform a callback to the given cbfunc. cbfunc will
+			 * take care the interrupt status clearing. If cbfunc
+			 * is not provided, then the interrupt clearing is here.
+			 */
+			if (cbfunc)
+				cbfunc(arg, irq_idx);
+			else
+				intr->ops.clear_intr_status_nolock(
+						intr, irq_idx);
+
+			/* clear every status bit served by this irq */
+			irq_status &= ~intr->sde_irq_map[irq_idx].irq_mask;
+			irq_status &= ~BIT(bit);
+		}
+
+		if (trace)
+			trace_sde_irq_dispatch(reg_idx,
+					intr->save_irq_status[reg_idx],
+					ktime_get_ns() - start_ns);
 	}
 	spin_unlock_irqrestore(&intr->irq_lock, irq_flags);
 }
@@ -988,6 +1002,7 @@ void sde_hw_intr_destroy(struct sde_hw_intr *intr)
 	if (intr) {
 		kfree(intr->sde_irq_tbl);
 		kfree(intr->sde_irq_map);
+		kfree(intr->irq_idx_lut);
 		kfree(intr->cache_irq_mask);
 		kfree(intr->save_irq_status);
 		kfree(intr);
@@ -1115,6 +1130,29 @@ static int _sde_copy_regs(struct sde_irq_type *sde_irq_map, u32 size,
 	return 0;
 }
 
+static void _sde_hw_intr_init_bit_map(struct sde_hw_intr *intr, u32 reg_idx)
+{
+	struct sde_intr_reg *reg = &intr->sde_irq_tbl[reg_idx];
+	unsigned long mask;
+	u32 i, bit;
+
+	reg->valid_mask = 0;
+	for (bit = 0; bit < ARRAY_SIZE(reg->bit_irq_idx); bit++)
+		reg->bit_irq_idx[bit] = -1;
+
+	/* lowest map index wins, matching the order of a linear search */
+	for (i = reg->map_idx_start; i < reg->map_idx_end; i++) {
+		mask = intr->sde_irq_map[i].irq_mask;
+		for_each_set_bit(bit, &mask, ARRAY_SIZE(reg->bit_irq_idx)) {
+			if (reg->bit_irq_idx[bit] >= 0)
+				continue;
+
+			reg->bit_irq_idx[bit] = i;
+			reg->valid_mask |= BIT(bit);
+		}
+	}
+}
+
 static int _sde_hw_intr_init_irq_tables(struct sde_hw_intr *intr,
 	struct sde_mdss_cfg *m)
 {
@@ -1157,6 +1195,7 @@ static int _sde_hw_intr_init_irq_tables(struct sde_hw_intr *intr,
 		 */
 		intr->sde_irq_tbl[sde_irq_tbl_idx].map_idx_start = low_idx;
 		intr->sde_irq_tbl[sde_irq_tbl_idx].map_idx_end = high_idx;
+		_sde_hw_intr_init_bit_map(intr, sde_irq_tbl_idx);
 		ret = _set_sde_irq_tbl_offset(
 				&intr->sde_irq_tbl[sde_irq_tbl_idx], item);
 		if (ret)
@@ -1172,6 +1211,44 @@ exit:
 	return ret;
 }
 
+static int _sde_hw_intr_init_irq_lut(struct sde_hw_intr *intr)
+{
+	struct sde_irq_type *irq;
+	u32 i, max_inst = 0, lut_idx;
+
+	for (i = 0; i < intr->sde_irq_map_size; i++) {
+		irq = &intr->sde_irq_map[i];
+		if (irq->intr_type < SDE_IRQ_TYPE_RESERVED &&
+				irq->instance_idx < SDE_IRQ_LUT_MAX_INSTANCE)
+			max_inst = max(max_inst, irq->instance_idx + 1);
+	}
+
+	intr->irq_idx_lut_inst = max_inst;
+	intr->irq_idx_lut = kmalloc_array(SDE_IRQ_TYPE_RESERVED * max_inst,
+			sizeof(*intr->irq_idx_lut), GFP_KERNEL);
+	if (!intr->irq_idx_lut) {
+		intr->irq_idx_lut_inst = 0;
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < SDE_IRQ_TYPE_RESERVED * max_inst; i++)
+		intr->irq_idx_lut[i] = -1;
+
+	/* keep the first match, same as a linear search of the map */
+	for (i = 0; i < intr->sde_irq_map_size; i++) {
+		irq = &intr->sde_irq_map[i];
+		if (irq->intr_type >= SDE_IRQ_TYPE_RESERVED ||
+				irq->instance_idx >= max_inst)
+			continue;
+
+		lut_idx = irq->intr_type * max_inst + irq->instance_idx;
+		if (intr->irq_idx_lut[lut_idx] < 0)
+			intr->irq_idx_lut[lut_idx] = i;
+	}
+
+	return 0;
+}
+
 struct sde_hw_intr *sde_hw_intr_init(void __iomem *addr,
 		struct sde_mdss_cfg *m)
 {
@@ -1246,6 +1323,10 @@ struct sde_hw_intr *sde_hw_intr_init(void __iomem *addr,
 	if (ret)
 		goto exit;
 
+	ret = _sde_hw_intr_init_irq_lut(intr);
+	if (ret)
+		goto exit;
+
 	intr->cache_irq_mask = kcalloc(intr->sde_irq_size,
 			sizeof(*intr->cache_irq_mask), GFP_KERNEL);
 	if (intr->cache_irq_mask == NULL) {
@@ -288,6 +288,9 @@ struct sde_hw_intr_ops {
  *		supported by the hw
  * @sde_irq_map_size: total number of elements of the 'sde_irq_map'
  * @sde_irq_map: total number of interrupt bits valid within the irq regs
+ * @irq_idx_lut: direct lookup of the irq_idx, indexed by
+ *		intr_type * irq_idx_lut_inst + instance_idx
+ * @irq_idx_lut_inst: number of instance slots per interrupt type
  */
 struct sde_hw_intr {
 	struct sde_hw_blk_reg_map hw;
@@ -298,6 +301,8 @@ struct sde_hw_intr {
 	struct sde_intr_reg *sde_irq_tbl;
 	u32 sde_irq_map_size;
 	struct sde_irq_type *sde_irq_map;
+	s32 *irq_idx_lut;
+	u32 irq_idx_lut_inst;
 	spinlock_t irq_lock;
 };
 
@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#include <kunit/test.h>
+#include <linux/ktime.h>
+#include <linux/vmalloc.h>
+
+#include "sde_hw_catalog.h"
+#include "sde_hw_interrupts.h"
+#include "sde_kunit.h"
+
+#define SDE_HW_INTR_TEST_REG_SIZE	0x10000
+#define SDE_HW_INTR_TEST_ROUNDS		1000
+
+/* instances looked up past the ones of the catalog, to check misses */
+#define SDE_HW_INTR_TEST_MAX_INSTANCE	(INTF_MAX + 4)
+
+/* interrupt register blocks of a dual intf target */
+static const struct {
+	enum sde_intr_hwblk_type type;
+	u32 instance;
+	u32 offset;
+} sde_hw_intr_test_blks[] = {
+	{SDE_INTR_HWBLK_TOP, SDE_INTR_TOP_INTR, 0x0},
+	{SDE_INTR_HWBLK_TOP, SDE_INTR_TOP_INTR2, 0x0},
+	{SDE_INTR_HWBLK_TOP, SDE_INTR_TOP_HIST_INTR, 0x0},
+	{SDE_INTR_HWBLK_INTF, INTF_1, 0x6b000},
+	{SDE_INTR_HWBLK_INTF, INTF_2, 0x6b800},
+	{SDE_INTR_HWBLK_INTF_TEAR, INTF_1, 0x6d000},
+	{SDE_INTR_HWBLK_INTF_TEAR, INTF_2, 0x6d800},
+	{SDE_INTR_HWBLK_AD4, DSPP_0, 0x55800},
+	{SDE_INTR_HWBLK_LTM, DSPP_0, 0x55a00},
+	{SDE_INTR_HWBLK_LTM, DSPP_1, 0x57a00},
+};
+
+/* the linear search of the irq map the lookup table replaces */
+static int sde_hw_intr_test_scan(struct sde_hw_intr *intr,
+		enum sde_intr_type intr_type, u32 instance_idx)
+{
+	int i;
+
+	for (i = 0; i < intr->sde_irq_map_size; i++) {
+		if (intr_type == intr->sde_irq_map[i].intr_type &&
+			instance_idx == intr->sde_irq_map[i].instance_idx)
+			return i;
+	}
+
+	return -EINVAL;
+}
+
+static struct sde_hw_intr *sde_hw_intr_test_init(struct kunit *test,
+		void __iomem **regs)
+{
+	struct sde_intr_irq_offsets *item;
+	struct sde_hw_intr *intr;
+	struct sde_mdss_cfg *cat;
+	int i;
+
+	cat = kunit_kzalloc(test, sizeof(*cat), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, cat);
+
+	*regs = (void __iomem __force *)vzalloc(SDE_HW_INTR_TEST_REG_SIZE);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, (void __force *)*regs);
+
+	cat->mdp_count = 1;
+	INIT_LIST_HEAD(&cat->irq_offset_list);
+
+	/* the items are freed by sde_hw_intr_init() once the map is built */
+	for (i = 0; i < ARRAY_SIZE(sde_hw_intr_test_blks); i++) {
+		item = kzalloc(sizeof(*item), GFP_KERNEL);
+		KUNIT_ASSERT_NOT_ERR_OR_NULL(test, item);
+
+		INIT_LIST_HEAD(&item->list);
+		item->type = sde_hw_intr_test_blks[i].type;
+		item->instance_idx = sde_hw_intr_test_blks[i].instance;
+		item->base_offset = sde_hw_intr_test_blks[i].offset;
+		list_add_tail(&item->list, &cat->irq_offset_list);
+	}
+
+	intr = sde_hw_intr_init(*regs, cat);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, intr);
+
+	return intr;
+}
+
+static void sde_hw_intr_test_lookup(struct kunit *test)
+{
+	struct sde_hw_intr *intr;
+	void __iomem *regs;
+	u32 type, inst;
+
+	intr = sde_hw_intr_test_init(test, &regs);
+
+	for (type = 0; type < SDE_IRQ_TYPE_RESERVED; type++) {
+		for (inst = 0; inst < SDE_HW_INTR_TEST_MAX_INSTANCE; inst++) {
+			KUNIT_EXPECT_EQ_MSG(test,
+				sde_hw_intr_test_scan(intr, type, inst),
+				intr->ops.irq_idx_lookup(intr, type, inst),
+				"type %u inst %u", type, inst);
+		}
+	}
+
+	/* types outside of the table still fail the lookup */
+	KUNIT_EXPECT_EQ(test, -EINVAL, intr->ops.irq_idx_lookup(intr,
+			SDE_IRQ_TYPE_RESERVED, INTF_1));
+
+	sde_hw_intr_destroy(intr);
+	vfree((void __force *)regs);
+}
+
+static u64 sde_hw_intr_test_time(struct sde_hw_intr *intr,
+		int (*lookup)(struct sde_hw_intr *intr,
+			enum sde_intr_type intr_type, u32 instance_idx))
+{
+	u64 start_ns;
+	u32 i, j;
+
+	start_ns = ktime_get_ns();
+	for (i = 0; i < SDE_HW_INTR_TEST_ROUNDS; i++)
+		for (j = 0; j < intr->sde_irq_map_size; j++)
+			lookup(intr, intr->sde_irq_map[j].intr_type,
+					intr->sde_irq_map[j].instance_idx);
+
+	return ktime_get_ns() - start_ns;
+}
+
+/* times a lookup of every interrupt of the map against the linear scan */
+static void sde_hw_intr_test_bench(struct kunit *test)
+{
+	struct sde_hw_intr *intr;
+	void __iomem *regs;
+	u64 scan_ns, lut_ns;
+
+	intr = sde_hw_intr_test_init(test, &regs);
+
+	scan_ns = sde_hw_intr_test_time(intr, sde_hw_intr_test_scan);
+	lut_ns = sde_hw_intr_test_time(intr, intr->ops.irq_idx_lookup);
+
+	kunit_info(test, "ns per irq map: scan:%llu lut:%llu\n",
+			div_u64(scan_ns, SDE_HW_INTR_TEST_ROUNDS),
+			div_u64(lut_ns, SDE_HW_INTR_TEST_ROUNDS));
+	KUNIT_EXPECT_LT(test, lut_ns, scan_ns);
+
+	sde_hw_intr_destroy(intr);
+	vfree((void __force *)regs);
+}
+
+static struct kunit_case sde_hw_intr_test_cases[] = {
+	KUNIT_CASE(sde_hw_intr_test_lookup),
+	KUNIT_CASE(sde_hw_intr_test_bench),
+	{}
+};
+
+struct kunit_suite sde_hw_intr_test_suite = {
+	.name = "sde_hw_interrupts",
+	.test_cases = sde_hw_intr_test_cases,
+};
@@ -852,6 +852,13 @@ struct sde_hw_intf *sde_hw_intf_init(enum sde_intf idx,
 	c->mdss = m;
 	_setup_intf_ops(&c->ops, c->cap->features);
 
+	rc = sde_hw_reg_shadow_init(&c->hw, cfg->name,
+			&m->reg_shadow[SDE_HW_BLK_INTF]);
+	if (rc) {
+		SDE_ERROR("failed to init reg shadow %d\n", rc);
+		goto blk_init_error;
+	}
+
 	rc = sde_hw_blk_init(&c->base, SDE_HW_BLK_INTF, idx, &sde_hw_ops);
 	if (rc) {
 		SDE_ERROR("failed to init hw blk %d\n", rc);
@@ -864,6 +871,7 @@ struct sde_hw_intf *sde_hw_intf_init(enum sde_intf idx,
 	return c;
 
 blk_init_error:
+	sde_hw_reg_shadow_destroy(&c->hw);
 	kzfree(c);
 
 	return ERR_PTR(rc);
@@ -871,8 +879,10 @@ blk_init_error:
 
 void sde_hw_intf_destroy(struct sde_hw_intf *intf)
 {
-	if (intf)
+	if (intf) {
 		sde_hw_blk_destroy(&intf->base);
+		sde_hw_reg_shadow_destroy(&intf->hw);
+	}
 	kfree(intf);
 }
 
@@ -329,6 +329,13 @@ struct sde_hw_mixer *sde_hw_lm_init(enum sde_lm idx,
 	c->cap = cfg;
 	_setup_mixer_ops(m, &c->ops, c->cap->features);
 
+	rc = sde_hw_reg_shadow_init(&c->hw, cfg->name,
+			&m->reg_shadow[SDE_HW_BLK_LM]);
+	if (rc) {
+		SDE_ERROR("failed to init reg shadow %d\n", rc);
+		goto blk_init_error;
+	}
+
 	rc = sde_hw_blk_init(&c->base, SDE_HW_BLK_LM, idx, &sde_hw_ops);
 	if (rc) {
 		SDE_ERROR("failed to init hw blk %d\n", rc);
@@ -341,6 +348,7 @@ struct sde_hw_mixer *sde_hw_lm_init(enum sde_lm idx,
 	return c;
 
 blk_init_error:
+	sde_hw_reg_shadow_destroy(&c->hw);
 	kzfree(c);
 
 	return ERR_PTR(rc);
@@ -348,7 +356,9 @@ blk_init_error:
 
 void sde_hw_lm_destroy(struct sde_hw_mixer *lm)
 {
-	if (lm)
+	if (lm) {
 		sde_hw_blk_destroy(&lm->base);
+		sde_hw_reg_shadow_destroy(&lm->hw);
+	}
 	kfree(lm);
 }
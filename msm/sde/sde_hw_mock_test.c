@@ -0,0 +1,330 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#include <kunit/test.h>
+#include <linux/ktime.h>
+#include <linux/vmalloc.h>
+#include <drm/drm_fourcc.h>
+
+#include "sde_hw_ctl.h"
+#include "sde_hw_intf.h"
+#include "sde_hw_lm.h"
+#include "sde_hw_sspp.h"
+#include "sde_hw_util.h"
+#include "sde_formats.h"
+#include "sde_kunit.h"
+
+/*
+ * Mock mmio backend: the register space is plain memory, so the sde_hw_*
+ * blocks program it through their regular writel/readl accessors and the
+ * tests read the result back. No clock, bus or interrupt is touched by
+ * the register programming paths exercised here.
+ */
+#define SDE_HW_MOCK_REG_SIZE		0x80000
+#define SDE_HW_MOCK_SSPP_BASE		0x4000
+#define SDE_HW_MOCK_CTL_BASE		0x16000
+#define SDE_HW_MOCK_LM_BASE		0x44000
+#define SDE_HW_MOCK_INTF_BASE		0x6b000
+
+/* register offsets checked by the tests, see the sde_hw_* blocks */
+#define SDE_HW_MOCK_CTL_FLUSH		0x018
+#define SDE_HW_MOCK_CTL_START		0x01c
+#define SDE_HW_MOCK_LM_OUT_SIZE		0x004
+#define SDE_HW_MOCK_SSPP_SRC0_ADDR	0x014
+
+#define SDE_HW_MOCK_FRAMES		1000
+#define SDE_HW_MOCK_WIDTH		1080
+#define SDE_HW_MOCK_HEIGHT		2400
+
+/* flush and start are triggers and must reach the hw on every frame */
+static const struct sde_reg_range sde_hw_mock_ctl_volatile[] = {
+	{SDE_HW_MOCK_CTL_FLUSH, 0x8},
+};
+
+/**
+ * struct sde_hw_mock - mock mmio backend and the blocks programmed through it
+ * @regs: memory backed register space
+ * @cat: catalog describing the blocks at their offsets in @regs
+ * @ctl: ctl path
+ * @lm: layer mixer
+ * @sspp: source pipe
+ * @intf: interface
+ */
+struct sde_hw_mock {
+	void __iomem *regs;
+	struct sde_mdss_cfg *cat;
+	struct sde_hw_ctl *ctl;
+	struct sde_hw_mixer *lm;
+	struct sde_hw_pipe *sspp;
+	struct sde_hw_intf *intf;
+};
+
+static void sde_hw_mock_catalog(struct kunit *test, struct sde_mdss_cfg *cat,
+		bool shadow)
+{
+	struct sde_sspp_sub_blks *sspp_sblk;
+	struct sde_lm_sub_blks *lm_sblk;
+	int i;
+
+	sspp_sblk = kunit_kzalloc(test, sizeof(*sspp_sblk), GFP_KERNEL);
+	lm_sblk = kunit_kzalloc(test, sizeof(*lm_sblk), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, sspp_sblk);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, lm_sblk);
+
+	cat->mdp_count = 1;
+	cat->mdp[0].id = MDP_TOP;
+
+	cat->sspp_count = 1;
+	snprintf(cat->sspp[0].name, SDE_HW_BLK_NAME_LEN, "sspp_0");
+	cat->sspp[0].id = SSPP_VIG0;
+	cat->sspp[0].base = SDE_HW_MOCK_SSPP_BASE;
+	cat->sspp[0].len = 0x1f0;
+	cat->sspp[0].features = BIT(SDE_SSPP_SRC);
+	cat->sspp[0].sblk = sspp_sblk;
+	cat->sspp[0].type = SSPP_TYPE_VIG;
+
+	lm_sblk->maxblendstages = 4;
+	for (i = 0; i < lm_sblk->maxblendstages; i++)
+		lm_sblk->blendstage_base[i] = 0x20 + i * 0x18;
+
+	cat->mixer_count = 1;
+	snprintf(cat->mixer[0].name, SDE_HW_BLK_NAME_LEN, "lm_0");
+	cat->mixer[0].id = LM_0;
+	cat->mixer[0].base = SDE_HW_MOCK_LM_BASE;
+	cat->mixer[0].len = 0x320;
+	cat->mixer[0].sblk = lm_sblk;
+
+	cat->ctl_count = 1;
+	snprintf(cat->ctl[0].name, SDE_HW_BLK_NAME_LEN, "ctl_0");
+	cat->ctl[0].id = CTL_0;
+	cat->ctl[0].base = SDE_HW_MOCK_CTL_BASE;
+	cat->ctl[0].len = 0x1e0;
+
+	cat->intf_count = 1;
+	snprintf(cat->intf[0].name, SDE_HW_BLK_NAME_LEN, "intf_1");
+	cat->intf[0].id = INTF_1;
+	cat->intf[0].base = SDE_HW_MOCK_INTF_BASE;
+	cat->intf[0].len = 0x2c0;
+	cat->intf[0].type = INTF_DSI;
+
+	sspp_sblk->reg_shadow.enable = shadow;
+	cat->reg_shadow[SDE_HW_BLK_LM].enable = shadow;
+	cat->reg_shadow[SDE_HW_BLK_CTL].enable = shadow;
+	cat->reg_shadow[SDE_HW_BLK_CTL].volatile_regs =
+			sde_hw_mock_ctl_volatile;
+	cat->reg_shadow[SDE_HW_BLK_CTL].volatile_count =
+			ARRAY_SIZE(sde_hw_mock_ctl_volatile);
+}
+
+static void sde_hw_mock_destroy(struct sde_hw_mock *mock)
+{
+	if (!IS_ERR_OR_NULL(mock->intf))
+		sde_hw_intf_destroy(mock->intf);
+	if (!IS_ERR_OR_NULL(mock->sspp))
+		sde_hw_sspp_destroy(mock->sspp);
+	if (!IS_ERR_OR_NULL(mock->lm))
+		sde_hw_lm_destroy(mock->lm);
+	if (!IS_ERR_OR_NULL(mock->ctl))
+		sde_hw_ctl_destroy(mock->ctl);
+	vfree((void __force *)mock->regs);
+	memset(mock, 0, sizeof(*mock));
+}
+
+static void sde_hw_mock_init(struct kunit *test, struct sde_hw_mock *mock,
+		bool shadow)
+{
+	memset(mock, 0, sizeof(*mock));
+
+	mock->cat = kunit_kzalloc(test, sizeof(*mock->cat), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, mock->cat);
+	sde_hw_mock_catalog(test, mock->cat, shadow);
+
+	mock->regs = (void __iomem __force *)vzalloc(SDE_HW_MOCK_REG_SIZE);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, (void __force *)mock->regs);
+
+	mock->ctl = sde_hw_ctl_init(CTL_0, mock->regs, mock->cat);
+	mock->lm = sde_hw_lm_init(LM_0, mock->regs, mock->cat);
+	mock->sspp = sde_hw_sspp_init(SSPP_VIG0, mock->regs, mock->cat,
+			false);
+	mock->intf = sde_hw_intf_init(INTF_1, mock->regs, mock->cat);
+	if (IS_ERR(mock->ctl) || IS_ERR(mock->lm) || IS_ERR(mock->sspp) ||
+			IS_ERR(mock->intf)) {
+		sde_hw_mock_destroy(mock);
+		KUNIT_FAIL(test, "failed to init the mock hw blocks");
+	}
+}
+
+static u32 sde_hw_mock_read(struct sde_hw_mock *mock, u32 blk_off, u32 reg)
+{
+	return readl_relaxed(mock->regs + blk_off + reg);
+}
+
+/* the modeset part of a video mode display bring up */
+static void sde_hw_mock_modeset(struct sde_hw_mock *mock,
+		const struct sde_format *fmt)
+{
+	struct intf_timing_params timing = {
+		.width = SDE_HW_MOCK_WIDTH,
+		.height = SDE_HW_MOCK_HEIGHT,
+		.xres = SDE_HW_MOCK_WIDTH,
+		.yres = SDE_HW_MOCK_HEIGHT,
+		.h_back_porch = 32,
+		.h_front_porch = 76,
+		.v_back_porch = 8,
+		.v_front_porch = 10,
+		.hsync_pulse_width = 4,
+		.vsync_pulse_width = 2,
+	};
+	struct sde_hw_mixer_cfg mixer = {
+		.out_width = SDE_HW_MOCK_WIDTH,
+		.out_height = SDE_HW_MOCK_HEIGHT,
+	};
+
+	mock->intf->ops.setup_timing_gen(mock->intf, &timing, fmt);
+	mock->lm->ops.setup_mixer_out(mock->lm, &mixer);
+}
+
+/* the per frame programming of a full screen plane flip */
+static void sde_hw_mock_frame(struct sde_hw_mock *mock,
+		const struct sde_format *fmt, u32 addr)
+{
+	struct sde_hw_stage_cfg stage = { { { 0 } } };
+	struct sde_hw_mixer_cfg mixer = {
+		.out_width = SDE_HW_MOCK_WIDTH,
+		.out_height = SDE_HW_MOCK_HEIGHT,
+	};
+	struct sde_hw_pipe_cfg pipe = {
+		.src_rect = { 0, 0, SDE_HW_MOCK_WIDTH, SDE_HW_MOCK_HEIGHT },
+		.dst_rect = { 0, 0, SDE_HW_MOCK_WIDTH, SDE_HW_MOCK_HEIGHT },
+	};
+	struct sde_hw_ctl *ctl = mock->ctl;
+
+	pipe.layout.format = fmt;
+	pipe.layout.num_planes = 1;
+	pipe.layout.plane_addr[0] = addr;
+	pipe.layout.plane_pitch[0] = SDE_HW_MOCK_WIDTH * 4;
+
+	mock->sspp->ops.setup_format(mock->sspp, fmt, false, 0,
+			SDE_SSPP_RECT_SOLO);
+	mock->sspp->ops.setup_rects(mock->sspp, &pipe, SDE_SSPP_RECT_SOLO);
+	mock->sspp->ops.setup_sourceaddress(mock->sspp, &pipe,
+			SDE_SSPP_RECT_SOLO);
+
+	mock->lm->ops.setup_mixer_out(mock->lm, &mixer);
+	mock->lm->ops.setup_blend_config(mock->lm, SDE_STAGE_0, 0xff, 0,
+			0x100);
+	mock->lm->ops.setup_alpha_out(mock->lm, 0);
+
+	stage.stage[SDE_STAGE_0][0] = SSPP_VIG0;
+	ctl->ops.clear_pending_flush(ctl);
+	ctl->ops.setup_blendstage(ctl, LM_0, &stage, false);
+	ctl->ops.update_bitmask_sspp(ctl, SSPP_VIG0, true);
+	ctl->ops.update_bitmask_mixer(ctl, LM_0, true);
+	ctl->ops.trigger_flush(ctl);
+	ctl->ops.trigger_start(ctl);
+
+	sde_hw_reg_io_frame_done();
+}
+
+static u64 sde_hw_mock_writes(struct sde_hw_mock *mock)
+{
+	u64 writes, reads, total = 0;
+
+	sde_hw_reg_io_get(&mock->ctl->hw, &writes, &reads);
+	total += writes;
+	sde_hw_reg_io_get(&mock->lm->hw, &writes, &reads);
+	total += writes;
+	sde_hw_reg_io_get(&mock->sspp->hw, &writes, &reads);
+	total += writes;
+	sde_hw_reg_io_get(&mock->intf->hw, &writes, &reads);
+	total += writes;
+
+	return total;
+}
+
+static void sde_hw_mock_test_frame(struct kunit *test)
+{
+	const struct sde_format *fmt = sde_get_sde_format(DRM_FORMAT_ARGB8888);
+	struct sde_hw_mock mock;
+
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, fmt);
+	sde_hw_mock_init(test, &mock, false);
+	if (!mock.regs)
+		return;
+
+	sde_hw_mock_modeset(&mock, fmt);
+	sde_hw_mock_frame(&mock, fmt, 0x10000000);
+
+	KUNIT_EXPECT_EQ(test, (u32)(SDE_HW_MOCK_HEIGHT << 16 |
+			SDE_HW_MOCK_WIDTH),
+			sde_hw_mock_read(&mock, SDE_HW_MOCK_LM_BASE,
+			SDE_HW_MOCK_LM_OUT_SIZE));
+	KUNIT_EXPECT_EQ(test, 0x10000000u,
+			sde_hw_mock_read(&mock, SDE_HW_MOCK_SSPP_BASE,
+			SDE_HW_MOCK_SSPP_SRC0_ADDR));
+	KUNIT_EXPECT_EQ(test, mock.ctl->flush.pending_flush_mask,
+			sde_hw_mock_read(&mock, SDE_HW_MOCK_CTL_BASE,
+			SDE_HW_MOCK_CTL_FLUSH));
+	KUNIT_EXPECT_EQ(test, 1u, sde_hw_mock_read(&mock,
+			SDE_HW_MOCK_CTL_BASE, SDE_HW_MOCK_CTL_START));
+
+	sde_hw_mock_destroy(&mock);
+}
+
+/* replays flips and reports the mmio writes and cpu time per frame */
+static void sde_hw_mock_bench(struct kunit *test, bool shadow,
+		u64 *writes_per_frame)
+{
+	const struct sde_format *fmt = sde_get_sde_format(DRM_FORMAT_ARGB8888);
+	struct sde_hw_mock mock;
+	u64 start_ns, ns, writes;
+	int i;
+
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, fmt);
+	sde_hw_mock_init(test, &mock, shadow);
+	if (!mock.regs)
+		return;
+
+	sde_hw_mock_modeset(&mock, fmt);
+	sde_hw_mock_frame(&mock, fmt, 0x10000000);
+	sde_hw_reg_io_reset();
+
+	start_ns = ktime_get_ns();
+	for (i = 0; i < SDE_HW_MOCK_FRAMES; i++)
+		sde_hw_mock_frame(&mock, fmt, 0x10000000 + (i % 3) * SZ_16M);
+	ns = ktime_get_ns() - start_ns;
+	writes = sde_hw_mock_writes(&mock);
+
+	*writes_per_frame = div_u64(writes, SDE_HW_MOCK_FRAMES);
+	kunit_info(test, "shadow:%d writes/frame:%llu ns/frame:%llu\n",
+			shadow, *writes_per_frame,
+			div_u64(ns, SDE_HW_MOCK_FRAMES));
+
+	/* the flush and start triggers are written on every frame */
+	KUNIT_EXPECT_GE(test, *writes_per_frame, 2ull);
+	sde_hw_mock_destroy(&mock);
+}
+
+static void sde_hw_mock_test_flip_bench(struct kunit *test)
+{
+	u64 uncached = 0, cached = 0;
+
+	sde_hw_mock_bench(test, false, &uncached);
+	sde_hw_mock_bench(test, true, &cached);
+
+	/* only the source address and the triggers change between flips */
+	KUNIT_EXPECT_LT(test, cached, uncached);
+}
+
+static struct kunit_case sde_hw_mock_test_cases[] = {
+	KUNIT_CASE(sde_hw_mock_test_frame),
+	KUNIT_CASE(sde_hw_mock_test_flip_bench),
+	{}
+};
+
+struct kunit_suite sde_hw_mock_test_suite = {
+	.name = "sde_hw_mock",
+	.test_cases = sde_hw_mock_test_cases,
+};
@@ -60,6 +60,9 @@
 #define WRAP_MAX_SIZE (BIT(4) - 1)
 #define MAX_DWORDS_SZ (BIT(14) - 1)
 #define REG_DMA_HEADERS_BUFFER_SZ (sizeof(u32) * 128)
+#define REG_DMA_BATCH_BUFFER_SZ (MAX_DWORDS_SZ * sizeof(u32))
+#define REG_DMA_ARENA_SZ SZ_1M
+#define REG_DMA_LAST_CMD_SZ (sizeof(u32) * 2)
 
 #define LUTBUS_TABLE_SEL_MASK 0x10000
 #define LUTBUS_BLOCK_SEL_MASK 0xffff
@@ -179,6 +182,36 @@ static reg_dma_internal_ops validate_dma_op_params[REG_DMA_SETUP_OPS_MAX] = {
 static struct sde_reg_dma_buffer *last_cmd_buf_db[CTL_MAX];
 static struct sde_reg_dma_buffer *last_cmd_buf_sb[CTL_MAX];
 
+#define REG_DMA_BATCH_BUFS 2
+
+/**
+ * struct reg_dma_batch - DB LUTDMA writes of a ctl merged for one frame
+ * @bufs: ping-pong buffers, the next frame is built in one while the hw may
+ *        still fetch the other
+ * @buf: buffer the write payloads of the current frame are copied into,
+ *       kicked off together with the last command
+ * @cur: index of buf in bufs
+ * @inflight: buffer was kicked off and its fetch isn't known to be done
+ * @issued_q: queue each buffer was last kicked off on
+ * @queue: queue the merged kickoffs were submitted to
+ * @count: number of kickoffs merged into buf
+ * @queued: buf was kicked off in the current frame
+ * @bypass: batching stopped until the last command after buf overflowed
+ */
+struct reg_dma_batch {
+	struct sde_reg_dma_buffer *bufs[REG_DMA_BATCH_BUFS];
+	struct sde_reg_dma_buffer *buf;
+	u32 cur;
+	bool inflight[REG_DMA_BATCH_BUFS];
+	enum sde_reg_dma_queue issued_q[REG_DMA_BATCH_BUFS];
+	enum sde_reg_dma_queue queue;
+	u32 count;
+	bool queued;
+	bool bypass;
+};
+
+static struct reg_dma_batch batch_db[CTL_MAX];
+
 static void get_decode_sel(unsigned long blk, u32 *decode_sel)
 {
 	int i = 0;
@@ -633,7 +666,16 @@ static int write_kick_off_v1(struct sde_reg_dma_kickoff_cfg *cfg)
 	struct sde_hw_blk_reg_map hw;
 
 	memset(&hw, 0, sizeof(hw));
-	msm_gem_sync(cfg->dma_buf->buf);
+
+	/*
+	 * arena chunks are mapped uncached and shared by many buffers, a
+	 * cache sync of the whole chunk would only cost time; drain the
+	 * write buffer before the hw reads the commands instead
+	 */
+	if (cfg->dma_buf->arena)
+		wmb();
+	else
+		msm_gem_sync(cfg->dma_buf->buf);
 	cmd1 = (cfg->op == REG_DMA_READ) ?
 		(dspp_read_sel[cfg->block_select] << 30) : 0;
 	cmd1 |= (cfg->last_command) ? BIT(24) : 0;
@@ -698,7 +740,7 @@ static int write_kick_off_v1(struct sde_reg_dma_kickoff_cfg *cfg)
 
 int init_v1(struct sde_hw_reg_dma *cfg)
 {
-	int i = 0, rc = 0;
+	int i = 0, k, rc = 0;
 
 	if (!cfg)
 		return -EINVAL;
@@ -731,6 +773,21 @@ int init_v1(struct sde_hw_reg_dma *cfg)
 				return 0;
 			}
 		}
+		for (k = 0; k < REG_DMA_BATCH_BUFS; k++) {
+			if (batch_db[i].bufs[k])
+				continue;
+
+			batch_db[i].bufs[k] =
+			    alloc_reg_dma_buf_v1(REG_DMA_BATCH_BUFFER_SZ);
+			if (IS_ERR_OR_NULL(batch_db[i].bufs[k])) {
+				/* with fewer buffers fewer frames are batched */
+				DRM_ERROR("failed to allocate batch buf ctl %d rc %ld\n",
+						i, PTR_ERR(batch_db[i].bufs[k]));
+				batch_db[i].bufs[k] = NULL;
+				break;
+			}
+		}
+		batch_db[i].buf = batch_db[i].bufs[0];
 	}
 	if (rc) {
 		for (i = 0; i < CTL_MAX; i++) {
@@ -906,6 +963,152 @@ static int setup_payload_v1(struct sde_reg_dma_setup_ops_cfg *cfg)
 }
 
 
+static void reset_batch_v1(struct reg_dma_batch *batch)
+{
+	if (batch->buf)
+		reset_reg_dma_buffer_v1(batch->buf);
+	batch->count = 0;
+	batch->queued = false;
+	batch->bypass = false;
+}
+
+/*
+ * Checks that the hw finished fetching the buffer about to be refilled. The
+ * ctl queue runs in order, so the done status of the latest trigger on the
+ * queue also covers the older buffer. No reg dma done irq is mapped and the
+ * commit path must not sleep on the hw, so the status is read once; while
+ * the buffer is busy the frame keeps the unbatched, hw serialized kickoffs.
+ */
+static bool batch_idle_v1(struct sde_hw_ctl *ctl,
+		struct reg_dma_batch *batch)
+{
+	struct sde_hw_blk_reg_map hw;
+	u32 val, mask;
+
+	if (!batch->inflight[batch->cur])
+		return true;
+
+	memset(&hw, 0, sizeof(hw));
+	SET_UP_REG_DMA_REG(hw, reg_dma, REG_DMA_TYPE_DB);
+	if (hw.hwversion == 0)
+		return false;
+
+	mask = ctl_trigger_done_mask[ctl->idx][batch->issued_q[batch->cur]];
+	val = readl_relaxed(hw.base_off + hw.blk_off +
+			reg_dma_intr_status_offset);
+	SDE_EVT32(ctl->idx, batch->cur, val, mask);
+	if (!(val & mask)) {
+		SDE_DEBUG("batch buf busy ctl %d val %x mask %x\n",
+				ctl->idx, val, mask);
+		return false;
+	}
+
+	memset(batch->inflight, 0, sizeof(batch->inflight));
+	atomic64_inc(&reg_dma->batch_stats.checks);
+
+	return true;
+}
+
+/* marks the buffer of this frame in flight and moves to the other one */
+static void swap_batch_v1(struct reg_dma_batch *batch,
+		enum sde_reg_dma_queue q)
+{
+	if (batch->queued) {
+		batch->inflight[batch->cur] = true;
+		batch->issued_q[batch->cur] = q;
+		if (batch->bufs[(batch->cur + 1) % REG_DMA_BATCH_BUFS]) {
+			batch->cur = (batch->cur + 1) % REG_DMA_BATCH_BUFS;
+			batch->buf = batch->bufs[batch->cur];
+		}
+	}
+
+	reset_batch_v1(batch);
+}
+
+static int flush_batch_v1(struct sde_hw_ctl *ctl, struct reg_dma_batch *batch,
+		bool last_command)
+{
+	struct sde_reg_dma_kickoff_cfg kick_off;
+	u32 *loc;
+	int rc;
+
+	if (last_command) {
+		loc = (u32 *)((u8 *)batch->buf->vaddr + batch->buf->index);
+		loc[0] = reg_dma_decode_sel;
+		loc[1] = 0;
+		batch->buf->index += REG_DMA_LAST_CMD_SZ;
+	}
+
+	memset(&kick_off, 0, sizeof(kick_off));
+	kick_off.ctl = ctl;
+	kick_off.op = REG_DMA_WRITE;
+	kick_off.dma_type = REG_DMA_TYPE_DB;
+	kick_off.queue_select = batch->queue;
+	kick_off.dma_buf = batch->buf;
+	kick_off.last_command = last_command;
+	kick_off.feature = REG_DMA_FEATURES_MAX;
+
+	rc = validate_kick_off_v1(&kick_off);
+	if (!rc)
+		rc = write_kick_off_v1(&kick_off);
+	if (rc)
+		DRM_ERROR("batch kick off failed ctl %d rc %d\n",
+				ctl->idx, rc);
+
+	atomic64_inc(&reg_dma->batch_stats.kickoffs);
+	SDE_EVT32(ctl->idx, batch->cur, batch->count, batch->buf->index,
+			last_command);
+	batch->count = 0;
+	batch->queued = true;
+
+	return rc;
+}
+
+/*
+ * Merges a validated DB LUTDMA write into the frame batch of its ctl. DB
+ * writes only execute on the sw trigger issued with the last command, so
+ * queueing them as a single command doesn't change when they take effect.
+ * Returns true if the kickoff was merged.
+ */
+static bool batch_kick_off_v1(struct sde_reg_dma_kickoff_cfg *cfg)
+{
+	struct reg_dma_batch *batch = &batch_db[cfg->ctl->idx];
+	struct sde_reg_dma_buffer *buf = batch->buf;
+	u32 len = cfg->dma_buf->index;
+
+	if (cfg->op != REG_DMA_WRITE || cfg->dma_type != REG_DMA_TYPE_DB ||
+			cfg->last_command || !buf || !buf->iova ||
+			batch->bypass)
+		return false;
+
+	if (batch->count && (batch->queue != cfg->queue_select ||
+			buf->index + len + REG_DMA_LAST_CMD_SZ >
+			buf->buffer_size)) {
+		/* keep the command order, send the rest of the frame as is */
+		flush_batch_v1(cfg->ctl, batch, false);
+		batch->bypass = true;
+		atomic64_inc(&reg_dma->batch_stats.overflows);
+		return false;
+	} else if (len + REG_DMA_LAST_CMD_SZ > buf->buffer_size) {
+		return false;
+	} else if (!batch->count && !batch_idle_v1(cfg->ctl, batch)) {
+		batch->bypass = true;
+		return false;
+	}
+
+	memcpy((u8 *)buf->vaddr + buf->index, cfg->dma_buf->vaddr, len);
+	buf->index += len;
+	buf->ops_completed |= cfg->dma_buf->ops_completed;
+	batch->queue = cfg->queue_select;
+	batch->count++;
+
+	atomic64_inc(&reg_dma->batch_stats.merged);
+	atomic64_add(len, &reg_dma->batch_stats.merged_bytes);
+	SDE_EVT32(cfg->feature, cfg->ctl->idx, batch->count, len);
+
+	return true;
+}
+
 static int kick_off_v1(struct sde_reg_dma_kickoff_cfg *cfg)
 {
 	int rc = 0;
@@ -914,6 +1117,9 @@ static int kick_off_v1(struct sde_reg_dma_kickoff_cfg *cfg)
 	if (rc)
 		return rc;
 
+	if (batch_kick_off_v1(cfg))
+		return 0;
+
 	rc = write_kick_off_v1(cfg);
 	return rc;
 }
@@ -929,6 +1135,10 @@ int reset_v1(struct sde_hw_ctl *ctl)
 		return -EINVAL;
 	}
 
+	reset_batch_v1(&batch_db[ctl->idx]);
+	memset(batch_db[ctl->idx].inflight, 0,
+			sizeof(batch_db[ctl->idx].inflight));
+
 	index = ctl->idx - CTL_0;
 	for (k = 0; k < REG_DMA_TYPE_MAX; k++) {
 		memset(&hw, 0, sizeof(hw));
@@ -953,6 +1163,365 @@ int reset_v1(struct sde_hw_ctl *ctl)
 	return 0;
 }
 
+/**
+ * struct reg_dma_arena_extent - free range of an arena chunk
+ * @list: node in the free list of the chunk, sorted by offset
+ * @offset: start of the range
+ * @size: size of the range
+ */
+struct reg_dma_arena_extent {
+	struct list_head list;
+	u32 offset;
+	u32 size;
+};
+
+/**
+ * struct reg_dma_arena - gem object shared by many reg dma buffers
+ * @list: node in arena_list
+ * @buf: drm gem handle for the chunk
+ * @aspace: address space the chunk is mapped in
+ * @iova: aligned device address of the chunk
+ * @vaddr: aligned cpu address of the chunk
+ * @used: bytes handed out to buffers
+ * @free_list: free ranges of the chunk
+ * @buf_list: buffers carved from the chunk
+ * @buf_lock: protects the addresses of the chunk and its buffers against
+ *            the aspace callback
+ */
+struct reg_dma_arena {
+	struct list_head list;
+	struct drm_gem_object *buf;
+	struct msm_gem_address_space *aspace;
+	u64 iova;
+	void *vaddr;
+	u32 used;
+	struct list_head free_list;
+	struct list_head buf_list;
+	spinlock_t buf_lock;
+};
+
+static LIST_HEAD(arena_list);
+static DEFINE_MUTEX(arena_lock);
+
+static void reg_dma_arena_cb_locked(void *cb_data, bool is_detach)
+{
+	struct reg_dma_arena *arena = cb_data;
+	struct sde_reg_dma_buffer *dma_buf;
+	void *vaddr = NULL;
+	u64 iova = 0;
+	u32 offset;
+	int rc;
+
+	if (!arena) {
+		DRM_ERROR("aspace cb called with invalid arena\n");
+		return;
+	}
+
+	if (is_detach) {
+		spin_lock(&arena->buf_lock);
+		arena->iova = 0;
+		list_for_each_entry(dma_buf, &arena->buf_list, arena_node)
+			dma_buf->iova = 0;
+		spin_unlock(&arena->buf_lock);
+
+		msm_gem_put_vaddr(arena->buf);
+		msm_gem_vunmap(arena->buf, OBJ_LOCK_NORMAL);
+		return;
+	}
+
+	rc = msm_gem_get_iova(arena->buf, arena->aspace, &iova);
+	if (rc) {
+		DRM_ERROR("failed to get the iova rc %d\n", rc);
+		return;
+	}
+
+	vaddr = msm_gem_get_vaddr(arena->buf);
+	if (IS_ERR_OR_NULL(vaddr)) {
+		DRM_ERROR("failed to get va rc %d\n", rc);
+		return;
+	}
+
+	offset = ((iova + GUARD_BYTES) & ALIGNED_OFFSET) - (u32)iova;
+
+	spin_lock(&arena->buf_lock);
+	arena->iova = iova + offset;
+	arena->vaddr = (u8 *)vaddr + offset;
+	list_for_each_entry(dma_buf, &arena->buf_list, arena_node) {
+		dma_buf->iova = arena->iova + dma_buf->arena_offset;
+		dma_buf->vaddr = (u8 *)arena->vaddr + dma_buf->arena_offset;
+		dma_buf->next_op_allowed = DECODE_SEL_OP;
+	}
+	spin_unlock(&arena->buf_lock);
+}
+
+static void destroy_arena_v1(struct reg_dma_arena *arena)
+{
+	struct reg_dma_arena_extent *ext, *tmp;
+
+	if (arena->buf) {
+		msm_gem_put_iova(arena->buf, arena->aspace);
+		msm_gem_address_space_unregister_cb(arena->aspace,
+				reg_dma_arena_cb_locked, arena);
+		mutex_lock(&reg_dma->drm_dev->struct_mutex);
+		msm_gem_free_object(arena->buf);
+		mutex_unlock(&reg_dma->drm_dev->struct_mutex);
+	}
+
+	list_for_each_entry_safe(ext, tmp, &arena->free_list, list) {
+		list_del(&ext->list);
+		kfree(ext);
+	}
+
+	kfree(arena);
+}
+
+static struct reg_dma_arena *create_arena_v1(void)
+{
+	struct reg_dma_arena *arena;
+	struct reg_dma_arena_extent *ext;
+	struct msm_gem_address_space *aspace;
+	u32 offset;
+	int rc;
+
+	arena = kzalloc(sizeof(*arena), GFP_KERNEL);
+	ext = kzalloc(sizeof(*ext), GFP_KERNEL);
+	if (!arena || !ext) {
+		kfree(arena);
+		kfree(ext);
+		return ERR_PTR(-ENOMEM);
+	}
+
+	INIT_LIST_HEAD(&arena->free_list);
+	INIT_LIST_HEAD(&arena->buf_list);
+	spin_lock_init(&arena->buf_lock);
+	ext->size = REG_DMA_ARENA_SZ;
+	list_add(&ext->list, &arena->free_list);
+
+	aspace = msm_gem_smmu_address_space_get(reg_dma->drm_dev,
+			MSM_SMMU_DOMAIN_UNSECURE);
+	if (PTR_ERR(aspace) == -ENODEV) {
+		aspace = NULL;
+	} else if (IS_ERR_OR_NULL(aspace)) {
+		rc = PTR_ERR(aspace);
+		DRM_ERROR("failed to get aspace %d", rc);
+		goto fail;
+	}
+
+	arena->buf = msm_gem_new(reg_dma->drm_dev,
+			REG_DMA_ARENA_SZ + GUARD_BYTES, MSM_BO_UNCACHED);
+	if (IS_ERR_OR_NULL(arena->buf)) {
+		arena->buf = NULL;
+		rc = -EINVAL;
+		goto fail;
+	}
+
+	if (aspace) {
+		rc = msm_gem_address_space_register_cb(aspace,
+				reg_dma_arena_cb_locked, arena);
+		if (rc) {
+			DRM_ERROR("failed to register callback %d", rc);
+			goto free_gem;
+		}
+	}
+
+	arena->aspace = aspace;
+	rc = msm_gem_get_iova(arena->buf, aspace, &arena->iova);
+	if (rc) {
+		DRM_ERROR("failed to get the iova rc %d\n", rc);
+		goto free_aspace_cb;
+	}
+
+	arena->vaddr = msm_gem_get_vaddr(arena->buf);
+	if (IS_ERR_OR_NULL(arena->vaddr)) {
+		DRM_ERROR("failed to get va\n");
+		rc = -EINVAL;
+		goto put_iova;
+	}
+
+	offset = ((arena->iova + GUARD_BYTES) & ALIGNED_OFFSET) -
+			(u32)arena->iova;
+	arena->iova += offset;
+	arena->vaddr = (u8 *)arena->vaddr + offset;
+
+	spin_lock(&reg_dma->arena_stats.lock);
+	reg_dma->arena_stats.chunks++;
+	reg_dma->arena_stats.size += REG_DMA_ARENA_SZ;
+	spin_unlock(&reg_dma->arena_stats.lock);
+
+	return arena;
+
+put_iova:
+	msm_gem_put_iova(arena->buf, aspace);
+free_aspace_cb:
+	msm_gem_address_space_unregister_cb(aspace,
+			reg_dma_arena_cb_locked, arena);
+free_gem:
+	mutex_lock(&reg_dma->drm_dev->struct_mutex);
+	msm_gem_free_object(arena->buf);
+	mutex_unlock(&reg_dma->drm_dev->struct_mutex);
+	arena->buf = NULL;
+fail:
+	destroy_arena_v1(arena);
+	return ERR_PTR(rc);
+}
+
+/* first fit on the free list, returns the offset or -ENOSPC */
+static s64 arena_get_range_v1(struct reg_dma_arena *arena, u32 size)
+{
+	struct reg_dma_arena_extent *ext;
+	u32 offset;
+
+	list_for_each_entry(ext, &arena->free_list, list) {
+		if (ext->size < size)
+			continue;
+
+		offset = ext->offset;
+		ext->offset += size;
+		ext->size -= size;
+		if (!ext->size) {
+			list_del(&ext->list);
+			kfree(ext);
+		}
+		arena->used += size;
+		return offset;
+	}
+
+	return -ENOSPC;
+}
+
+/* returns the range to the free list, merging it with its neighbours */
+static int arena_put_range_v1(struct reg_dma_arena *arena, u32 offset,
+		u32 size)
+{
+	struct reg_dma_arena_extent *ext, *prev = NULL, *next = NULL;
+
+	list_for_each_entry(ext, &arena->free_list, list) {
+		if (ext->offset > offset) {
+			next = ext;
+			break;
+		}
+		prev = ext;
+	}
+
+	if (prev && prev->offset + prev->size == offset) {
+		prev->size += size;
+		if (next && prev->offset + prev->size == next->offset) {
+			prev->size += next->size;
+			list_del(&next->list);
+			kfree(next);
+		}
+	} else if (next && offset + size == next->offset) {
+		next->offset = offset;
+		next->size += size;
+	} else {
+		ext = kzalloc(sizeof(*ext), GFP_KERNEL);
+		if (!ext)
+			return -ENOMEM;
+		ext->offset = offset;
+		ext->size = size;
+		if (prev)
+			list_add(&ext->list, &prev->list);
+		else
+			list_add(&ext->list, &arena->free_list);
+	}
+
+	arena->used -= size;
+	return 0;
+}
+
+static struct sde_reg_dma_buffer *alloc_arena_buf_v1(u32 size)
+{
+	struct sde_reg_dma_arena_stats *stats = &reg_dma->arena_stats;
+	struct sde_reg_dma_buffer *dma_buf;
+	struct reg_dma_arena *arena;
+	u32 asize = ALIGN(size + GUARD_BYTES, ADDR_ALIGN);
+	s64 offset = -ENOSPC;
+
+	if (asize > REG_DMA_ARENA_SZ)
+		return NULL;
+
+	dma_buf = kzalloc(sizeof(*dma_buf), GFP_KERNEL);
+	if (!dma_buf)
+		return NULL;
+
+	mutex_lock(&arena_lock);
+	list_for_each_entry(arena, &arena_list, list) {
+		offset = arena_get_range_v1(arena, asize);
+		if (offset >= 0)
+			break;
+	}
+
+	if (offset < 0) {
+		arena = create_arena_v1();
+		if (IS_ERR(arena)) {
+			mutex_unlock(&arena_lock);
+			kfree(dma_buf);
+			return NULL;
+		}
+		list_add_tail(&arena->list, &arena_list);
+		offset = arena_get_range_v1(arena, asize);
+	}
+
+	dma_buf->buf = arena->buf;
+	dma_buf->aspace = arena->aspace;
+	dma_buf->buffer_size = size;
+	dma_buf->arena = arena;
+	dma_buf->arena_offset = offset;
+	dma_buf->arena_size = asize;
+
+	spin_lock(&arena->buf_lock);
+	if (arena->iova)
+		dma_buf->iova = arena->iova + offset;
+	dma_buf->vaddr = (u8 *)arena->vaddr + offset;
+	list_add_tail(&dma_buf->arena_node, &arena->buf_list);
+	spin_unlock(&arena->buf_lock);
+	dma_buf->next_op_allowed = DECODE_SEL_OP;
+
+	spin_lock(&stats->lock);
+	stats->buffers++;
+	stats->used += asize;
+	stats->peak = max(stats->peak, stats->used);
+	spin_unlock(&stats->lock);
+	mutex_unlock(&arena_lock);
+
+	return dma_buf;
+}
+
+static int dealloc_arena_buf_v1(struct sde_reg_dma_buffer *dma_buf)
+{
+	struct sde_reg_dma_arena_stats *stats = &reg_dma->arena_stats;
+	struct reg_dma_arena *arena = dma_buf->arena;
+	int rc;
+
+	mutex_lock(&arena_lock);
+	spin_lock(&arena->buf_lock);
+	list_del(&dma_buf->arena_node);
+	spin_unlock(&arena->buf_lock);
+
+	rc = arena_put_range_v1(arena, dma_buf->arena_offset,
+			dma_buf->arena_size);
+	if (rc)
+		DRM_ERROR("leaked %u bytes of arena rc %d\n",
+				dma_buf->arena_size, rc);
+
+	spin_lock(&stats->lock);
+	stats->buffers--;
+	stats->used -= dma_buf->arena_size;
+	spin_unlock(&stats->lock);
+	if (list_empty(&arena->buf_list)) {
+		list_del(&arena->list);
+		destroy_arena_v1(arena);
+		spin_lock(&stats->lock);
+		stats->chunks--;
+		stats->size -= REG_DMA_ARENA_SZ;
+		spin_unlock(&stats->lock);
+	}
+	mutex_unlock(&arena_lock);
+
+	kfree(dma_buf);
+	return 0;
+}
+
 static void sde_reg_dma_aspace_cb_locked(void *cb_data, bool is_detach)
 {
 	struct sde_reg_dma_buffer *dma_buf = NULL;
@@ -1012,6 +1581,14 @@ static struct sde_reg_dma_buffer *alloc_reg_dma_buf_v1(u32 size)
 		return ERR_PTR(-EINVAL);
 	}
 
+	/* small buffers share one mapping instead of a gem object each */
+	dma_buf = alloc_arena_buf_v1(size);
+	if (dma_buf)
+		return dma_buf;
+	spin_lock(&reg_dma->arena_stats.lock);
+	reg_dma->arena_stats.fallbacks++;
+	spin_unlock(&reg_dma->arena_stats.lock);
+
 	dma_buf = kzalloc(sizeof(*dma_buf), GFP_KERNEL);
 	if (!dma_buf)
 		return ERR_PTR(-ENOMEM);
@@ -1089,6 +1666,9 @@ static int dealloc_reg_dma_v1(struct sde_reg_dma_buffer *dma_buf)
 		return -EINVAL;
 	}
 
+	if (dma_buf->arena)
+		return dealloc_arena_buf_v1(dma_buf);
+
 	if (dma_buf->buf) {
 		msm_gem_put_iova(dma_buf->buf, 0);
 		msm_gem_address_space_unregister_cb(dma_buf->aspace,
@@ -1148,6 +1728,7 @@ static int last_cmd_v1(struct sde_hw_ctl *ctl, enum sde_reg_dma_queue q,
 	struct sde_reg_dma_setup_ops_cfg cfg;
 	struct sde_reg_dma_kickoff_cfg kick_off;
 	struct sde_hw_blk_reg_map hw;
+	struct reg_dma_batch *batch;
 	u32 val;
 	int rc;
 
@@ -1157,6 +1738,19 @@ static int last_cmd_v1(struct sde_hw_ctl *ctl, enum sde_reg_dma_queue q,
 		return -EINVAL;
 	}
 
+	batch = &batch_db[ctl->idx];
+	if (batch->count && batch->queue == q) {
+		/* one kickoff for all writes of the frame and the last cmd */
+		rc = flush_batch_v1(ctl, batch, true);
+		swap_batch_v1(batch, q);
+		if (rc)
+			return rc;
+		goto wait;
+	} else if (batch->count) {
+		flush_batch_v1(ctl, batch, false);
+	}
+	swap_batch_v1(batch, q);
+
 	if (!last_cmd_buf_db[ctl->idx] || !last_cmd_buf_db[ctl->idx]->iova) {
 		DRM_ERROR("invalid last cmd buf for idx %d\n", ctl->idx);
 		return -EINVAL;
@@ -1188,12 +1782,13 @@ static int last_cmd_v1(struct sde_hw_ctl *ctl, enum sde_reg_dma_queue q,
 		return rc;
 	}
 
+wait:
 	//Lack of block support will be caught by kick_off
 	memset(&hw, 0, sizeof(hw));
-	SET_UP_REG_DMA_REG(hw, reg_dma, kick_off.dma_type);
+	SET_UP_REG_DMA_REG(hw, reg_dma, REG_DMA_TYPE_DB);
 
-	SDE_EVT32(SDE_EVTLOG_FUNC_ENTRY, mode, ctl->idx, kick_off.queue_select,
-			kick_off.dma_type, kick_off.op);
+	SDE_EVT32(SDE_EVTLOG_FUNC_ENTRY, mode, ctl->idx, q,
+			REG_DMA_TYPE_DB, REG_DMA_WRITE);
 	if (mode == REG_DMA_WAIT4_COMP) {
 		rc = readl_poll_timeout(hw.base_off + hw.blk_off +
 			reg_dma_intr_status_offset, val,
@@ -1202,6 +1797,8 @@ static int last_cmd_v1(struct sde_hw_ctl *ctl, enum sde_reg_dma_queue q,
 		if (rc)
 			DRM_ERROR("poll wait failed %d val %x mask %x\n",
 			    rc, val, ctl_trigger_done_mask[ctl->idx][q]);
+		else
+			memset(batch->inflight, 0, sizeof(batch->inflight));
 		SDE_EVT32(SDE_EVTLOG_FUNC_EXIT, mode);
 	}
 
@@ -1210,7 +1807,7 @@ static int last_cmd_v1(struct sde_hw_ctl *ctl, enum sde_reg_dma_queue q,
 
 void deinit_v1(void)
 {
-	int i = 0;
+	int i = 0, k;
 
 	for (i = CTL_0; i < CTL_MAX; i++) {
 		if (last_cmd_buf_db[i])
@@ -1219,6 +1816,10 @@ void deinit_v1(void)
 		if (last_cmd_buf_sb[i])
 			dealloc_reg_dma_v1(last_cmd_buf_sb[i]);
 		last_cmd_buf_sb[i] = NULL;
+		for (k = 0; k < REG_DMA_BATCH_BUFS; k++)
+			if (batch_db[i].bufs[k])
+				dealloc_reg_dma_v1(batch_db[i].bufs[k]);
+		memset(&batch_db[i], 0, sizeof(batch_db[i]));
 	}
 }
 
@@ -1345,6 +1345,14 @@ struct sde_hw_pipe *sde_hw_sspp_init(enum sde_sspp idx,
 		sde_init_scaler_blk(&hw_pipe->cap->sblk->scaler_blk,
 			catalog->qseed_hw_version);
 
+	/* virtual pipes share the cache of the physical pipe */
+	rc = sde_hw_reg_shadow_init(&hw_pipe->hw, cfg->name,
+			&cfg->sblk->reg_shadow);
+	if (rc) {
+		SDE_ERROR("failed to init reg shadow %d\n", rc);
+		goto blk_init_error;
+	}
+
 	rc = sde_hw_blk_init(&hw_pipe->base, SDE_HW_BLK_SSPP, idx, &sde_hw_ops);
 	if (rc) {
 		SDE_ERROR("failed to init hw blk %d\n", rc);
@@ -1368,6 +1376,8 @@ struct sde_hw_pipe *sde_hw_sspp_init(enum sde_sspp idx,
 	return hw_pipe;
 
 blk_init_error:
+	sde_hw_reg_shadow_destroy(&hw_pipe->hw);
+	kfree(cfg);
 	kzfree(hw_pipe);
 
 	return ERR_PTR(rc);
@@ -1377,6 +1387,7 @@ void sde_hw_sspp_destroy(struct sde_hw_pipe *ctx)
 {
 	if (ctx) {
 		sde_hw_blk_destroy(&ctx->base);
+		sde_hw_reg_shadow_destroy(&ctx->hw);
 		reg_dmav1_deinit_sspp_ops(ctx->idx);
 		kfree(ctx->cap);
 	}
@@ -4,6 +4,9 @@
  */
 #define pr_fmt(fmt)	"[drm:%s:%d] " fmt, __func__, __LINE__
 
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/percpu.h>
 #include <drm/sde_drm.h>
 #include "msm_drv.h"
 #include "sde_kms.h"
@@ -65,10 +68,344 @@ static u32 sde_hw_util_log_mask = SDE_DBG_MASK_NONE;
 #define QSEED4_DEFAULT_PRELOAD_H 0x4
 
 #define GET_REG_BLK_ID(c) (c->log_mask ? (ilog2(c->log_mask) + 1) : 0)
+#define SDE_HW_REG_IO_BLK_MAX 33
+
+#ifdef SDE_HW_REG_IO_STATS
+#define SDE_HW_REG_IO_INC(c, dir) \
+	this_cpu_inc(sde_hw_reg_io_stats.dir[GET_REG_BLK_ID(c)])
+#else
+#define SDE_HW_REG_IO_INC(c, dir)
+#endif
 typedef void (*scaler_lut_type)(struct sde_hw_blk_reg_map *,
 		struct sde_hw_scaler3_cfg *, u32);
 
-void sde_reg_write(struct sde_hw_blk_reg_map *c,
+/**
+ * struct sde_hw_reg_shadow - last values written to a register block
+ * @list:         node in the global list of shadow caches
+ * @refcount:     number of register maps sharing this cache
+ * @name:         block name for debugfs reporting
+ * @base_off:     mapped base of the block, used to share the cache
+ * @blk_off:      block offset, used to share the cache
+ * @count:        number of 32-bit registers covered by the cache
+ * @gen:          invalidation generation the valid bitmap belongs to
+ * @elided:       writes skipped because the value was already programmed
+ * @issued:       writes sent to the hardware
+ * @val:          last value written per register
+ * @valid:        registers whose cached value matches the hardware
+ * @volatile_map: registers that always bypass the cache
+ */
+struct sde_hw_reg_shadow {
+	struct list_head list;
+	u32 refcount;
+	char name[SDE_HW_BLK_NAME_LEN];
+	void __iomem *base_off;
+	u32 blk_off;
+	u32 count;
+	u32 gen;
+	u64 elided;
+	u64 issued;
+	u32 *val;
+	unsigned long *valid;
+	unsigned long *volatile_map;
+};
+
+#ifdef SDE_HW_REG_IO_STATS
+/**
+ * struct sde_hw_reg_io_stats - mmio accesses issued by the sde_hw_* blocks
+ * @writes: register writes per block type, indexed by GET_REG_BLK_ID
+ * @reads: register reads per block type, indexed by GET_REG_BLK_ID
+ */
+struct sde_hw_reg_io_stats {
+	u64 writes[SDE_HW_REG_IO_BLK_MAX];
+	u64 reads[SDE_HW_REG_IO_BLK_MAX];
+};
+
+static DEFINE_PER_CPU(struct sde_hw_reg_io_stats, sde_hw_reg_io_stats);
+static atomic64_t sde_hw_reg_io_frames = ATOMIC64_INIT(0);
+#endif
+
+static LIST_HEAD(sde_hw_reg_shadow_list);
+static DEFINE_MUTEX(sde_hw_reg_shadow_lock);
+static atomic_t sde_hw_reg_shadow_gen = ATOMIC_INIT(0);
+
+/* returns true if the write can be skipped */
+static bool _sde_hw_reg_shadow_elide(struct sde_hw_reg_shadow *shadow,
+		u32 reg_off, u32 val)
+{
+	u32 i = reg_off >> 2;
+	u32 gen;
+
+	if ((reg_off & 0x3) || i >= shadow->count ||
+			test_bit(i, shadow->volatile_map))
+		goto issue;
+
+	gen = atomic_read(&sde_hw_reg_shadow_gen);
+	if (unlikely(shadow->gen != gen)) {
+		bitmap_zero(shadow->valid, shadow->count);
+		shadow->gen = gen;
+	}
+
+	if (test_bit(i, shadow->valid) && shadow->val[i] == val) {
+		shadow->elided++;
+		return true;
+	}
+
+	shadow->val[i] = val;
+	__set_bit(i, shadow->valid);
+issue:
+	shadow->issued++;
+	return false;
+}
+
+int sde_hw_reg_shadow_init(struct sde_hw_blk_reg_map *c, const char *name,
+		const struct sde_reg_shadow_cfg *cfg)
+{
+	struct sde_hw_reg_shadow *shadow;
+	u32 i, start, end, count;
+	size_t map_size;
+
+	if (!c || !cfg)
+		return -EINVAL;
+
+	if (!cfg->enable || !c->length)
+		return 0;
+
+	mutex_lock(&sde_hw_reg_shadow_lock);
+	list_for_each_entry(shadow, &sde_hw_reg_shadow_list, list) {
+		if (shadow->base_off == c->base_off &&
+				shadow->blk_off == c->blk_off) {
+			shadow->refcount++;
+			c->shadow = shadow;
+			mutex_unlock(&sde_hw_reg_shadow_lock);
+			return 0;
+		}
+	}
+
+	count = c->length >> 2;
+	map_size = BITS_TO_LONGS(count) * sizeof(unsigned long);
+	shadow = kzalloc(sizeof(*shadow) + count * sizeof(u32) + 2 * map_size,
+			GFP_KERNEL);
+	if (!shadow) {
+		mutex_unlock(&sde_hw_reg_shadow_lock);
+		return -ENOMEM;
+	}
+
+	shadow->val = (u32 *)(shadow + 1);
+	shadow->valid = (unsigned long *)(shadow->val + count);
+	shadow->volatile_map = (unsigned long *)((u8 *)shadow->valid +
+			map_size);
+	shadow->count = count;
+	shadow->refcount = 1;
+	shadow->base_off = c->base_off;
+	shadow->blk_off = c->blk_off;
+	shadow->gen = atomic_read(&sde_hw_reg_shadow_gen);
+	strlcpy(shadow->name, name, sizeof(shadow->name));
+
+	for (i = 0; i < cfg->volatile_count; i++) {
+		start = cfg->volatile_regs[i].start >> 2;
+		end = DIV_ROUND_UP(cfg->volatile_regs[i].start +
+				cfg->volatile_regs[i].len, 4);
+		if (start >= count)
+			continue;
+		bitmap_set(shadow->volatile_map, start,
+				min(end, count) - start);
+	}
+
+	list_add_tail(&shadow->list, &sde_hw_reg_shadow_list);
+	c->shadow = shadow;
+	mutex_unlock(&sde_hw_reg_shadow_lock);
+
+	return 0;
+}
+
+void sde_hw_reg_shadow_destroy(struct sde_hw_blk_reg_map *c)
+{
+	struct sde_hw_reg_shadow *shadow;
+
+	if (!c || !c->shadow)
+		return;
+
+	shadow = c->shadow;
+	c->shadow = NULL;
+
+	mutex_lock(&sde_hw_reg_shadow_lock);
+	if (--shadow->refcount == 0) {
+		list_del(&shadow->list);
+		kfree(shadow);
+	}
+	mutex_unlock(&sde_hw_reg_shadow_lock);
+}
+
+void sde_hw_reg_shadow_invalidate_all(void)
+{
+	atomic_inc(&sde_hw_reg_shadow_gen);
+}
+
+#ifdef SDE_HW_REG_IO_STATS
+void sde_hw_reg_io_frame_done(void)
+{
+	atomic64_inc(&sde_hw_reg_io_frames);
+}
+
+void sde_hw_reg_io_get(const struct sde_hw_blk_reg_map *c,
+		u64 *writes, u64 *reads)
+{
+	int cpu, id = GET_REG_BLK_ID(c);
+
+	*writes = 0;
+	*reads = 0;
+	for_each_possible_cpu(cpu) {
+		*writes += per_cpu(sde_hw_reg_io_stats, cpu).writes[id];
+		*reads += per_cpu(sde_hw_reg_io_stats, cpu).reads[id];
+	}
+}
+
+void sde_hw_reg_io_reset(void)
+{
+	int cpu;
+
+	/* racing updates may be lost */
+	for_each_possible_cpu(cpu)
+		memset(per_cpu_ptr(&sde_hw_reg_io_stats, cpu), 0,
+				sizeof(struct sde_hw_reg_io_stats));
+	atomic64_set(&sde_hw_reg_io_frames, 0);
+}
+#endif
+
+#ifdef CONFIG_DEBUG_FS
+static int _sde_hw_reg_shadow_show(struct seq_file *s, void *v)
+{
+	struct sde_hw_reg_shadow *shadow;
+	u64 elided = 0, issued = 0;
+
+	mutex_lock(&sde_hw_reg_shadow_lock);
+	list_for_each_entry(shadow, &sde_hw_reg_shadow_list, list) {
+		seq_printf(s, "%-16s off:0x%x elided:%llu issued:%llu\n",
+				shadow->name, shadow->blk_off,
+				shadow->elided, shadow->issued);
+		elided += shadow->elided;
+		issued += shadow->issued;
+	}
+	mutex_unlock(&sde_hw_reg_shadow_lock);
+
+	seq_printf(s, "total elided:%llu issued:%llu\n", elided, issued);
+
+	return 0;
+}
+
+static int _sde_hw_reg_shadow_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, _sde_hw_reg_shadow_show, inode->i_private);
+}
+
+static ssize_t _sde_hw_reg_shadow_write(struct file *file,
+		const char __user *user_buf, size_t count, loff_t *ppos)
+{
+	struct sde_hw_reg_shadow *shadow;
+
+	/* any write resets the statistics */
+	mutex_lock(&sde_hw_reg_shadow_lock);
+	list_for_each_entry(shadow, &sde_hw_reg_shadow_list, list) {
+		shadow->elided = 0;
+		shadow->issued = 0;
+	}
+	mutex_unlock(&sde_hw_reg_shadow_lock);
+
+	return count;
+}
+
+static const struct file_operations sde_hw_reg_shadow_fops = {
+	.owner = THIS_MODULE,
+	.open = _sde_hw_reg_shadow_open,
+	.release = single_release,
+	.read = seq_read,
+	.write = _sde_hw_reg_shadow_write,
+	.llseek = seq_lseek,
+};
+
+#ifdef SDE_HW_REG_IO_STATS
+static const char * const sde_hw_reg_io_blk_names[] = {
+	"default", "none", "cdm", "dspp", "intf", "lm", "ctl", "pingpong",
+	"sspp", "wb", "top", "vbif", "dsc", "rot", "ds", "regdma", "uidle",
+	"qdss", "vdc",
+};
+
+static int _sde_hw_reg_io_show(struct seq_file *s, void *v)
+{
+	u64 writes, reads, total_writes = 0, total_reads = 0, frames;
+	int cpu, i;
+
+	frames = atomic64_read(&sde_hw_reg_io_frames);
+	for (i = 0; i < SDE_HW_REG_IO_BLK_MAX; i++) {
+		writes = 0;
+		reads = 0;
+		for_each_possible_cpu(cpu) {
+			writes += per_cpu(sde_hw_reg_io_stats, cpu).writes[i];
+			reads += per_cpu(sde_hw_reg_io_stats, cpu).reads[i];
+		}
+		if (!writes && !reads)
+			continue;
+
+		if (i < ARRAY_SIZE(sde_hw_reg_io_blk_names))
+			seq_printf(s, "%-10s", sde_hw_reg_io_blk_names[i]);
+		else
+			seq_printf(s, "blk%-7d", i);
+		seq_printf(s, " writes:%llu reads:%llu writes/frame:%llu\n",
+				writes, reads,
+				frames ? div64_u64(writes, frames) : 0);
+		total_writes += writes;
+		total_reads += reads;
+	}
+
+	seq_printf(s, "total frames:%llu writes:%llu reads:%llu\n",
+			frames, total_writes, total_reads);
+	seq_printf(s, "total writes/frame:%llu reads/frame:%llu\n",
+			frames ? div64_u64(total_writes, frames) : 0,
+			frames ? div64_u64(total_reads, frames) : 0);
+
+	return 0;
+}
+
+static int _sde_hw_reg_io_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, _sde_hw_reg_io_show, inode->i_private);
+}
+
+static ssize_t _sde_hw_reg_io_write(struct file *file,
+		const char __user *user_buf, size_t count, loff_t *ppos)
+{
+	/* any write resets the statistics */
+	sde_hw_reg_io_reset();
+
+	return count;
+}
+
+static const struct file_operations sde_hw_reg_io_fops = {
+	.owner = THIS_MODULE,
+	.open = _sde_hw_reg_io_open,
+	.release = single_release,
+	.read = seq_read,
+	.write = _sde_hw_reg_io_write,
+	.llseek = seq_lseek,
+};
+#endif
+
+void sde_hw_reg_shadow_debugfs_init(struct dentry *debugfs_root)
+{
+	debugfs_create_file("reg_shadow", 0600, debugfs_root, NULL,
+			&sde_hw_reg_shadow_fops);
+#ifdef SDE_HW_REG_IO_STATS
+	debugfs_create_file("reg_io_stats", 0600, debugfs_root, NULL,
+			&sde_hw_reg_io_fops);
+#endif
+}
+#else
+void sde_hw_reg_shadow_debugfs_init(struct dentry *debugfs_root)
+{
+}
+#endif
+
+static void _sde_reg_write(struct sde_hw_blk_reg_map *c,
 		u32 reg_off,
 		u32 val,
 		const char *name)
@@ -78,12 +415,29 @@ void sde_reg_write(struct sde_hw_blk_reg_map *c,
 		SDE_DEBUG_DRIVER("[%s:0x%X] <= 0x%X\n",
 				name, c->blk_off + reg_off, val);
 	SDE_EVT32_REGWRITE(c->blk_off + reg_off, val, GET_REG_BLK_ID(c));
+	SDE_HW_REG_IO_INC(c, writes);
 	writel_relaxed(val, c->base_off + c->blk_off + reg_off);
 	SDE_REG_LOG(GET_REG_BLK_ID(c), val, c->blk_off + reg_off);
 }
 
+void sde_reg_write(struct sde_hw_blk_reg_map *c,
+		u32 reg_off,
+		u32 val,
+		const char *name)
+{
+	/*
+	 * Writers of a block, including the rects of a multirect pipe that
+	 * share its cache, are serialized by the commit of their crtc.
+	 */
+	if (c->shadow && _sde_hw_reg_shadow_elide(c->shadow, reg_off, val))
+		return;
+
+	_sde_reg_write(c, reg_off, val, name);
+}
+
 int sde_reg_read(struct sde_hw_blk_reg_map *c, u32 reg_off)
 {
+	SDE_HW_REG_IO_INC(c, reads);
 	return readl_relaxed(c->base_off + c->blk_off + reg_off);
 }
 
@@ -17,7 +17,9 @@
 #define REG_MASK_SHIFT_ULL(n, shift)    ((REG_MASK_ULL(n)) << (shift))
 #define LP_DDR4_TYPE			0x7
 
+struct dentry;
 struct sde_format_extended;
+struct sde_hw_reg_shadow;
 
 /*
  * This is the common struct maintained by each sub block
@@ -28,6 +30,7 @@ struct sde_format_extended;
  * @length        length of register block offset
  * @xin_id        xin id
  * @hwversion     mdss hw version number
+ * @shadow        optional cache of the last written register values
  */
 struct sde_hw_blk_reg_map {
 	void __iomem *base_off;
@@ -36,6 +39,7 @@ struct sde_hw_blk_reg_map {
 	u32 xin_id;
 	u32 hwversion;
 	u32 log_mask;
+	struct sde_hw_reg_shadow *shadow;
 };
 
 /**
@@ -181,6 +185,86 @@ int sde_reg_read(struct sde_hw_blk_reg_map *c, u32 reg_off);
 #define SDE_REG_WRITE(c, off, val) sde_reg_write(c, off, val, #off)
 #define SDE_REG_READ(c, off) sde_reg_read(c, off)
 
+/**
+ * sde_hw_reg_shadow_init - attach a register shadow cache to a block
+ * @c:    register map of the block
+ * @name: block name used for debugfs reporting
+ * @cfg:  catalog shadow settings of the block type
+ *
+ * Register maps describing the same hardware block share one cache.
+ * Return: 0 on success or when caching is disabled, error code otherwise
+ */
+int sde_hw_reg_shadow_init(struct sde_hw_blk_reg_map *c, const char *name,
+		const struct sde_reg_shadow_cfg *cfg);
+
+/**
+ * sde_hw_reg_shadow_destroy - detach and free the register shadow cache
+ * @c:    register map of the block
+ */
+void sde_hw_reg_shadow_destroy(struct sde_hw_blk_reg_map *c);
+
+/**
+ * sde_hw_reg_shadow_invalidate_all - drop all cached register values
+ *
+ * Must be called whenever the hardware may have lost or changed its register
+ * contents behind the driver, e.g. power collapse, reset or vm handoff.
+ */
+void sde_hw_reg_shadow_invalidate_all(void);
+
+/*
+ * Per block type counters of the mmio accesses, built only with
+ * CONFIG_DRM_MSM_SDE_REG_IO_STATS, off in every target config, and for the
+ * mock mmio test suite since they sit in the register access path.
+ */
+#if defined(CONFIG_DRM_MSM_SDE_REG_IO_STATS) || \
+		defined(CONFIG_DRM_MSM_SDE_KUNIT_TEST)
+#define SDE_HW_REG_IO_STATS
+#endif
+
+#ifdef SDE_HW_REG_IO_STATS
+/**
+ * sde_hw_reg_io_frame_done - account one committed frame in the mmio
+ *	statistics, used to report register accesses per frame
+ */
+void sde_hw_reg_io_frame_done(void);
+
+/**
+ * sde_hw_reg_io_get - read the mmio accesses counted for a block type
+ * @c:      register map of a block of the type
+ * @writes: output, number of register writes
+ * @reads:  output, number of register reads
+ */
+void sde_hw_reg_io_get(const struct sde_hw_blk_reg_map *c,
+		u64 *writes, u64 *reads);
+
+/**
+ * sde_hw_reg_io_reset - clear the mmio access statistics
+ */
+void sde_hw_reg_io_reset(void);
+#else
+static inline void sde_hw_reg_io_frame_done(void)
+{
+}
+
+static inline void sde_hw_reg_io_get(const struct sde_hw_blk_reg_map *c,
+		u64 *writes, u64 *reads)
+{
+	*writes = 0;
+	*reads = 0;
+}
+
+static inline void sde_hw_reg_io_reset(void)
+{
+}
+#endif
+
+/**
+ * sde_hw_reg_shadow_debugfs_init - create the shadow cache and mmio access
+ *	statistics nodes
+ * @debugfs_root: parent debugfs directory
+ */
+void sde_hw_reg_shadow_debugfs_init(struct dentry *debugfs_root);
+
 #define MISR_FRAME_COUNT_MASK		0xFF
 #define MISR_CTRL_ENABLE		BIT(8)
 #define MISR_CTRL_STATUS		BIT(9)
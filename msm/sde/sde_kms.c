@@ -146,6 +146,8 @@ static int _sde_debugfs_init(struct sde_kms *sde_kms)
 
 	/* allow debugfs_root to be NULL */
 	debugfs_create_x32(SDE_DEBUGFS_HWMASKNAME, 0600, debugfs_root, p);
+	sde_hw_reg_shadow_debugfs_init(debugfs_root);
+	sde_reg_dma_debugfs_init(debugfs_root);
 
 	(void) sde_debugfs_vbif_init(sde_kms, debugfs_root);
 	(void) sde_debugfs_core_irq_init(sde_kms, debugfs_root);
@@ -163,6 +165,9 @@ static int _sde_debugfs_init(struct sde_kms *sde_kms)
 	debugfs_create_u32("pm_suspend_clk_dump", 0600, debugfs_root,
 			(u32 *)&sde_kms->pm_suspend_clk_dump);
 
+	debugfs_create_u32("rm_rsvp_reuse", 0400, debugfs_root,
+			&sde_kms->rm.rsvp_reuse_cnt);
+
 	return 0;
 }
 
@@ -1050,6 +1055,9 @@ int sde_kms_vm_primary_prepare_commit(struct sde_kms *sde_kms,
 	if (vm_req != VM_REQ_ACQUIRE)
 		return 0;
 
+	/* trusted vm may have reprogrammed the hardware */
+	sde_hw_reg_shadow_invalidate_all();
+
 	/* enable MDSS irq line */
 	sde_irq_update(&sde_kms->base, true);
 
@@ -4303,6 +4311,8 @@ static void sde_kms_handle_power_event(u32 event_type, void *usr)
 	SDE_EVT32_VERBOSE(event_type);
 
 	if (event_type == SDE_POWER_EVENT_POST_ENABLE) {
+		/* register contents may have been lost during power collapse */
+		sde_hw_reg_shadow_invalidate_all();
 		sde_irq_update(msm_kms, true);
 		sde_kms->first_kickoff = true;
 
@@ -4786,6 +4796,8 @@ static int sde_kms_hw_init(struct msm_kms *kms)
 		goto end;
 	}
 
+	sde_format_init_hash();
+
 	rc = _sde_kms_hw_init_ioremap(sde_kms, platformdev);
 	if (rc)
 		goto error;
@@ -208,31 +208,48 @@ struct sde_kms_smmu_state_data {
 
 /*
  * struct sde_irq_callback - IRQ callback handlers
- * @list: list to callback
  * @func: intr handler
  * @arg: argument for the handler
  */
 struct sde_irq_callback {
-	struct list_head list;
 	void (*func)(void *arg, int irq_idx);
 	void *arg;
 };
 
+/**
+ * struct sde_irq_cb_time - callback handling time of one irq
+ * @count: number of timed dispatches
+ * @total_ns: accumulated callback handling time
+ * @max_ns: longest callback handling time
+ */
+struct sde_irq_cb_time {
+	u64 count;
+	u64 total_ns;
+	u64 max_ns;
+};
+
 /**
  * struct sde_irq: IRQ structure contains callback registration info
  * @total_irq:    total number of irq_idx obtained from HW interrupts mapping
- * @irq_cb_tbl:   array of IRQ callbacks setting
+ * @irq_cb_tbl:   array of rcu protected lists of the registered callbacks
  * @enable_counts array of IRQ enable counts
- * @cb_lock:      callback lock
+ * @irq_counts:   array of IRQ dispatch counts
+ * @cb_time:      array of callback handling time per irq
+ * @cb_timing:    debug knob, times the callbacks when set
+ * @cb_lock:      serializes the callback list updates
  * @debugfs_file: debugfs file for irq statistics
+ * @debugfs_timing: debugfs file for the cb_timing knob
  */
 struct sde_irq {
 	u32 total_irqs;
 	struct list_head *irq_cb_tbl;
 	atomic_t *enable_counts;
 	atomic_t *irq_counts;
+	struct sde_irq_cb_time *cb_time;
+	bool cb_timing;
 	spinlock_t cb_lock;
 	struct dentry *debugfs_file;
+	struct dentry *debugfs_timing;
 };
 
 /**
@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#include <kunit/test.h>
+
+#include "sde_kunit.h"
+
+static struct kunit_suite * const sde_kunit_suites[] = {
+	&sde_hw_intr_test_suite,
+	&sde_formats_test_suite,
+	&sde_core_perf_test_suite,
+	&sde_hw_mock_test_suite,
+	&sde_rm_graph_test_suite,
+#ifdef CONFIG_DSI_PARSER
+	&dsi_parser_test_suite,
+#endif
+};
+
+void sde_kunit_run(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(sde_kunit_suites); i++)
+		kunit_run_tests(sde_kunit_suites[i]);
+}
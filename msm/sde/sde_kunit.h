@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#ifndef __SDE_KUNIT_H__
+#define __SDE_KUNIT_H__
+
+#ifdef CONFIG_DRM_MSM_SDE_KUNIT_TEST
+struct kunit_suite;
+
+extern struct kunit_suite sde_hw_intr_test_suite;
+extern struct kunit_suite sde_formats_test_suite;
+extern struct kunit_suite sde_core_perf_test_suite;
+extern struct kunit_suite sde_hw_mock_test_suite;
+extern struct kunit_suite sde_rm_graph_test_suite;
+#ifdef CONFIG_DSI_PARSER
+extern struct kunit_suite dsi_parser_test_suite;
+#endif
+
+/**
+ * sde_kunit_run - run the kunit suites built into msm_drm
+ *
+ * The suites live in the msm_drm module, which has its own module init, so
+ * they are run from there rather than through kunit_test_suite().
+ */
+void sde_kunit_run(void);
+#else
+static inline void sde_kunit_run(void)
+{
+}
+#endif
+
+#endif /* __SDE_KUNIT_H__ */
@@ -83,6 +83,48 @@ enum sde_plane_qos {
 	SDE_PLANE_QOS_PANIC_CTRL = BIT(2),
 };
 
+/**
+ * struct sde_plane_check_fp - inputs of the sspp atomic check validation
+ * @crtc: crtc the plane is attached to
+ * @src_x: source x offset, Q16
+ * @src_y: source y offset, Q16
+ * @src_w: source width, Q16
+ * @src_h: source height, Q16
+ * @crtc_x: destination x offset
+ * @crtc_y: destination y offset
+ * @crtc_w: destination width
+ * @crtc_h: destination height
+ * @fb_width: framebuffer width
+ * @fb_height: framebuffer height
+ * @format: framebuffer pixel format
+ * @modifier: framebuffer format modifier
+ * @multirect_index: multirect rectangle index
+ * @multirect_mode: multirect mode
+ * @scaler_check_state: scaler validation state
+ * @rot_limits: inline rotation limits, tunable through debugfs
+ * @rt_client: whether the crtc is a real time client
+ * @default_scale: whether the debugfs default scaling is forced
+ * @excl_rect: exclusion rectangle, set through a volatile property
+ * @props: values of the non-volatile plane properties
+ */
+struct sde_plane_check_fp {
+	struct drm_crtc *crtc;
+	u32 src_x, src_y, src_w, src_h;
+	s32 crtc_x, crtc_y;
+	u32 crtc_w, crtc_h;
+	u32 fb_width, fb_height;
+	u32 format;
+	u64 modifier;
+	u32 multirect_index;
+	u32 multirect_mode;
+	u32 scaler_check_state;
+	u32 rot_limits[4];
+	bool rt_client;
+	bool default_scale;
+	struct sde_rect excl_rect;
+	u64 props[PLANE_PROP_COUNT];
+};
+
 /*
  * struct sde_plane - local sde plane structure
  * @aspace: address space pointer
@@ -94,6 +136,10 @@ enum sde_plane_qos {
  * @revalidate: force revalidation of all the plane properties
  * @xin_halt_forced_clk: whether or not clocks were forced on for xin halt
  * @blob_rot_caps: Pointer to rotator capability blob
+ * @check_fp: inputs of the last sspp atomic check that passed validation
+ * @check_fp_valid: whether check_fp holds a validated fingerprint
+ * @check_hits: atomic checks that reused the validated fingerprint
+ * @check_misses: atomic checks that ran the full validation
  */
 struct sde_plane {
 	struct drm_plane base;
@@ -136,6 +182,11 @@ struct sde_plane {
 	struct drm_property_blob *blob_info;
 	struct drm_property_blob *blob_rot_caps;
 
+	struct sde_plane_check_fp check_fp;
+	bool check_fp_valid;
+	u32 check_hits;
+	u32 check_misses;
+
 	/* debugfs related stuff */
 	struct dentry *debugfs_root;
 	bool debugfs_default_scale;
@@ -2562,6 +2613,59 @@ static int _sde_plane_sspp_atomic_check_helper(struct sde_plane *psde,
 	return ret;
 }
 
+/*
+ * Fills the fingerprint of everything the sspp validation depends on.
+ * Returns false if the state must always be validated.
+ */
+static bool _sde_plane_check_fingerprint(struct sde_plane *psde,
+		struct drm_plane_state *state, struct sde_plane_check_fp *fp)
+{
+	struct sde_plane_state *pstate = to_sde_plane_state(state);
+	const struct sde_sspp_sub_blks *sblk = psde->pipe_sblk;
+	struct drm_crtc_state *cstate;
+	int i;
+
+	/* new scaler configurations are validated and promoted once */
+	if (!state->fb || !state->crtc || !state->state ||
+			pstate->scaler_check_state ==
+			SDE_PLANE_SCLCHECK_SCALER_V2_CHECK)
+		return false;
+
+	memset(fp, 0, sizeof(*fp));
+	fp->crtc = state->crtc;
+	fp->src_x = state->src_x;
+	fp->src_y = state->src_y;
+	fp->src_w = state->src_w;
+	fp->src_h = state->src_h;
+	fp->crtc_x = state->crtc_x;
+	fp->crtc_y = state->crtc_y;
+	fp->crtc_w = state->crtc_w;
+	fp->crtc_h = state->crtc_h;
+	fp->fb_width = state->fb->width;
+	fp->fb_height = state->fb->height;
+	fp->format = state->fb->format->format;
+	fp->modifier = state->fb->modifier;
+	fp->multirect_index = pstate->multirect_index;
+	fp->multirect_mode = pstate->multirect_mode;
+	fp->scaler_check_state = pstate->scaler_check_state;
+	fp->excl_rect = pstate->excl_rect;
+	fp->rot_limits[0] = sblk->in_rot_maxdwnscale_rt_num;
+	fp->rot_limits[1] = sblk->in_rot_maxdwnscale_rt_denom;
+	fp->rot_limits[2] = sblk->in_rot_maxdwnscale_nrt;
+	fp->rot_limits[3] = sblk->in_rot_maxheight;
+	fp->default_scale = psde->debugfs_default_scale;
+
+	cstate = drm_atomic_get_new_crtc_state(state->state, state->crtc);
+	fp->rt_client = sde_crtc_is_rt_client(state->crtc, cstate);
+
+	/* volatile properties like the input fence change on every commit */
+	for (i = 0; i < PLANE_PROP_COUNT; i++)
+		if (!psde->property_data[i].force_dirty)
+			fp->props[i] = pstate->property_values[i].value;
+
+	return true;
+}
+
 static int sde_plane_sspp_atomic_check(struct drm_plane *plane,
 		struct drm_plane_state *state)
 {
@@ -2573,6 +2677,8 @@ static int sde_plane_sspp_atomic_check(struct drm_plane *plane,
 	struct sde_rect src, dst;
 	bool q16_data = true;
 	struct drm_framebuffer *fb;
+	struct sde_plane_check_fp fp;
+	bool cacheable;
 	u32 width;
 	u32 height;
 
@@ -2615,6 +2721,15 @@ static int sde_plane_sspp_atomic_check(struct drm_plane *plane,
 	msm_fmt = msm_framebuffer_format(fb);
 	fmt = to_sde_format(msm_fmt);
 
+	/* plain flips of a validated configuration skip the validation */
+	cacheable = _sde_plane_check_fingerprint(psde, state, &fp);
+	if (cacheable && psde->check_fp_valid &&
+			!memcmp(&fp, &psde->check_fp, sizeof(fp))) {
+		psde->check_hits++;
+		goto validated;
+	}
+	psde->check_misses++;
+
 	ret = _sde_plane_sspp_atomic_check_helper(psde, fmt, src, dst, width,
 			height);
 	if (ret)
@@ -2630,6 +2745,12 @@ static int sde_plane_sspp_atomic_check(struct drm_plane *plane,
 	if (ret)
 		return ret;
 
+	if (cacheable) {
+		psde->check_fp = fp;
+		psde->check_fp_valid = true;
+	}
+
+validated:
 	ret = _sde_plane_validate_shared_crtc(psde, state);
 	if (ret)
 		return ret;
@@ -4523,6 +4644,11 @@ static int _sde_plane_init_debugfs(struct drm_plane *plane)
 			psde->debugfs_root,
 			kms, &sde_plane_danger_enable);
 
+	debugfs_create_u32("check_cache_hits", 0400,
+			psde->debugfs_root, &psde->check_hits);
+	debugfs_create_u32("check_cache_misses", 0400,
+			psde->debugfs_root, &psde->check_misses);
+
 	return 0;
 }
 
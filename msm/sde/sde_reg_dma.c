@@ -4,6 +4,8 @@
  */
 
 #define pr_fmt(fmt)	"[drm:%s:%d] " fmt, __func__, __LINE__
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #include "sde_reg_dma.h"
 #include "sde_hw_reg_dma_v1.h"
 #include "sde_dbg.h"
@@ -96,6 +98,7 @@ int sde_reg_dma_init(void __iomem *addr, struct sde_mdss_cfg *m,
 {
 	int rc = 0;
 	set_default_dma_ops(&reg_dma);
+	spin_lock_init(&reg_dma.arena_stats.lock);
 
 	if (!addr || !m || !dev) {
 		DRM_DEBUG("invalid addr %pK catalog %pK dev %pK\n", addr, m,
@@ -162,3 +165,60 @@ void sde_reg_dma_deinit(void)
 	memset(&reg_dma, 0, sizeof(reg_dma));
 	set_default_dma_ops(&reg_dma);
 }
+
+#ifdef CONFIG_DEBUG_FS
+static int _sde_reg_dma_stats_show(struct seq_file *s, void *data)
+{
+	struct sde_reg_dma_batch_stats *stats = &reg_dma.batch_stats;
+	struct sde_reg_dma_arena_stats *arena = &reg_dma.arena_stats;
+	u32 chunks, size, used, peak, buffers, fallbacks;
+
+	seq_printf(s, "batch merged:%lld bytes:%lld\n",
+			atomic64_read(&stats->merged),
+			atomic64_read(&stats->merged_bytes));
+	seq_printf(s, "batch kickoffs:%lld overflows:%lld checks:%lld\n",
+			atomic64_read(&stats->kickoffs),
+			atomic64_read(&stats->overflows),
+			atomic64_read(&stats->checks));
+
+	spin_lock(&arena->lock);
+	chunks = arena->chunks;
+	size = arena->size;
+	used = arena->used;
+	peak = arena->peak;
+	buffers = arena->buffers;
+	fallbacks = arena->fallbacks;
+	spin_unlock(&arena->lock);
+
+	seq_printf(s, "arena chunks:%u size:%u used:%u peak:%u\n",
+			chunks, size, used, peak);
+	seq_printf(s, "arena buffers:%u fallbacks:%u\n", buffers, fallbacks);
+
+	return 0;
+}
+
+static int _sde_reg_dma_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, _sde_reg_dma_stats_show, inode->i_private);
+}
+
+static const struct file_operations sde_reg_dma_stats_fops = {
+	.open = _sde_reg_dma_stats_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+void sde_reg_dma_debugfs_init(struct dentry *root)
+{
+	if (!root || !reg_dma.drm_dev)
+		return;
+
+	debugfs_create_file("reg_dma_stats", 0400, root, NULL,
+			&sde_reg_dma_stats_fops);
+}
+#else
+void sde_reg_dma_debugfs_init(struct dentry *root)
+{
+}
+#endif /* CONFIG_DEBUG_FS */
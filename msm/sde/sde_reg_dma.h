@@ -232,6 +232,10 @@ enum sde_reg_dma_last_cmd_mode {
  * @vaddr: cpu address
  * @next_op_allowed: operation allowed on the buffer
  * @ops_completed: operations completed on buffer
+ * @arena: arena chunk the buffer was carved from, NULL if it owns @buf
+ * @arena_node: node in the buffer list of @arena
+ * @arena_offset: offset of the buffer in @arena
+ * @arena_size: aligned size reserved in @arena
  */
 struct sde_reg_dma_buffer {
 	struct drm_gem_object *buf;
@@ -242,6 +246,10 @@ struct sde_reg_dma_buffer {
 	void *vaddr;
 	u32 next_op_allowed;
 	u32 ops_completed;
+	void *arena;
+	struct list_head arena_node;
+	u32 arena_offset;
+	u32 arena_size;
 };
 
 /**
@@ -342,6 +350,43 @@ struct sde_hw_reg_dma_ops {
 	void (*dump_regs)(void);
 };
 
+/**
+ * struct sde_reg_dma_batch_stats - statistics of the per-ctl kickoff batching
+ * @merged: number of kickoffs merged into a batch
+ * @merged_bytes: number of command bytes merged into a batch
+ * @kickoffs: number of batch kickoffs issued to the hw
+ * @overflows: number of batches flushed early as the next payload didn't fit
+ * @checks: number of times a frame confirmed the hw finished fetching the
+ *          batch buffer it was about to refill
+ */
+struct sde_reg_dma_batch_stats {
+	atomic64_t merged;
+	atomic64_t merged_bytes;
+	atomic64_t kickoffs;
+	atomic64_t overflows;
+	atomic64_t checks;
+};
+
+/**
+ * struct sde_reg_dma_arena_stats - usage of the reg dma buffer arena
+ * @chunks: number of arena chunks mapped
+ * @size: total size of the arena chunks
+ * @used: bytes handed out to buffers, including alignment
+ * @peak: highest value of @used
+ * @buffers: number of buffers carved from the arena
+ * @fallbacks: number of buffers that got their own gem object
+ * @lock: protects the counters against concurrent updates and reads
+ */
+struct sde_reg_dma_arena_stats {
+	u32 chunks;
+	u32 size;
+	u32 used;
+	u32 peak;
+	u32 buffers;
+	u32 fallbacks;
+	spinlock_t lock;
+};
+
 /**
  * struct sde_hw_reg_dma - structure to hold reg dma hw info
  * @drm_dev: drm driver dev handle
@@ -349,6 +394,8 @@ struct sde_hw_reg_dma_ops {
  * @caps: LUTDMA hw caps on the platform
  * @ops: reg dma ops supported on the platform
  * @addr: reg dma hw block base address
+ * @batch_stats: statistics of the per-ctl kickoff batching
+ * @arena_stats: usage of the reg dma buffer arena
  */
 struct sde_hw_reg_dma {
 	struct drm_device *drm_dev;
@@ -356,6 +403,8 @@ struct sde_hw_reg_dma {
 	const struct sde_reg_dma_cfg *caps;
 	struct sde_hw_reg_dma_ops ops;
 	void __iomem *addr;
+	struct sde_reg_dma_batch_stats batch_stats;
+	struct sde_reg_dma_arena_stats arena_stats;
 };
 
 /**
@@ -383,4 +432,10 @@ struct sde_hw_reg_dma_ops *sde_reg_dma_get_ops(void);
  * sde_reg_dma_deinit() - de-initialize the reg dma
  */
 void sde_reg_dma_deinit(void);
+
+/**
+ * sde_reg_dma_debugfs_init() - create the reg dma debugfs nodes
+ * @root: debugfs parent directory
+ */
+void sde_reg_dma_debugfs_init(struct dentry *root);
 #endif /* _SDE_REG_DMA_H */
@@ -33,7 +33,6 @@
 				(t).num_comp_enc == (r).num_enc && \
 				(t).num_intf == (r).num_intf && \
 				(t).comp_type == (r).comp_type)
-#define IS_COMPATIBLE_PP_DSC(p, d) (p % 2 == d % 2)
 
 /* ~one vsync poll time for rsvp_nxt to cleared by modeset from commit thread */
 #define RM_NXT_CLEAR_POLL_TIMEOUT_US 16600
@@ -115,6 +114,34 @@ struct sde_rm_requirements {
 	u32 conn_lm_mask;
 };
 
+/**
+ * struct sde_rm_rsvp_key - Subset of the requirements that decides which hw
+ *	blocks a reservation gets. Two requests with the same key result in
+ *	the same reservation, so a committed one can be kept as is.
+ * @top_ctrl:		topology control preference, incl. dspp/ds/cwb bits
+ * @topology:		selected topology table entry
+ * @intfs:		interface modes requested by the encoder
+ * @wbs:		writeback modes requested by the encoder
+ * @needs_cdm:		whether a cdm block is needed
+ * @display_type:	primary/secondary display preference
+ * @comp_type:		compression type
+ * @native_422_420:	dsc native 422/420 support is required
+ * @cwb_requested_disp_type:	display type of the cwb source
+ * @conn_lm_mask:	mixers used by the cwb source connector
+ */
+struct sde_rm_rsvp_key {
+	uint64_t top_ctrl;
+	const struct sde_rm_topology_def *topology;
+	enum sde_intf_mode intfs[INTF_MAX];
+	enum sde_intf_mode wbs[WB_MAX];
+	bool needs_cdm;
+	enum sde_connector_display display_type;
+	enum msm_display_compression_type comp_type;
+	bool native_422_420;
+	u32 cwb_requested_disp_type;
+	u32 conn_lm_mask;
+};
+
 /**
  * struct sde_rm_rsvp - Use Case Reservation tagging structure
  *	Used to tag HW blocks as reserved by a CRTC->Encoder->Connector chain
@@ -129,6 +156,8 @@ struct sde_rm_requirements {
  *		An encoder or connector id identifies the display path.
  * @topology:	DRM<->HW topology use case
  * @pending:	True for pending rsvp-nxt, cleared when the rsvp is committed
+ * @key:	Requirements the reservation was made for
+ * @blks:	Per block type mask of the blocks tagged with the reservation
  */
 struct sde_rm_rsvp {
 	struct list_head list;
@@ -136,6 +165,8 @@ struct sde_rm_rsvp {
 	uint32_t enc_id;
 	enum sde_rm_topology_name topology;
 	bool pending;
+	struct sde_rm_rsvp_key key;
+	unsigned long blks[SDE_HW_BLK_MAX];
 };
 
 /**
@@ -330,6 +361,14 @@ static void _sde_rm_print_rsvps_by_type(
 	}
 }
 
+const struct sde_rm_topology_def *sde_rm_get_topology_table(u32 ctl_rev)
+{
+	if (IS_SDE_CTL_REV_100(ctl_rev))
+		return g_top_table_v1;
+
+	return g_top_table;
+}
+
 struct sde_hw_mdp *sde_rm_get_mdp(struct sde_rm *rm)
 {
 	return rm->hw_mdp;
@@ -614,6 +653,8 @@ static int _sde_rm_hw_blk_create(
 	blk->id = id;
 	blk->hw = hw;
 	list_add_tail(&blk->list, &rm->hw_blks[type]);
+	if (id < SDE_RM_GRAPH_MAX_ID)
+		rm->blk_map[type][id] = blk;
 
 	_sde_rm_inc_resource_info(rm, &rm->avail_res, blk);
 
@@ -751,10 +792,7 @@ int sde_rm_init(struct sde_rm *rm,
 
 	rm->dev = dev;
 
-	if (IS_SDE_CTL_REV_100(cat->ctl_rev))
-		rm->topology_tbl = g_top_table_v1;
-	else
-		rm->topology_tbl = g_top_table;
+	rm->topology_tbl = sde_rm_get_topology_table(cat->ctl_rev);
 
 	/* Some of the sub-blocks require an mdptop to be created */
 	rm->hw_mdp = sde_hw_mdptop_init(MDP_TOP, mmio, cat);
@@ -795,290 +833,82 @@ int sde_rm_init(struct sde_rm *rm,
 	}
 
 	rc = _sde_rm_hw_blk_create_new(rm, cat, mmio);
+	if (rc)
+		goto fail;
+
+	rc = sde_rm_graph_init(&rm->graph, cat);
 	if (!rc)
 		return 0;
 
+	SDE_ERROR("failed to build the block compatibility graph\n");
+
 fail:
 	sde_rm_destroy(rm);
 
 	return rc;
 }
 
-static bool _sde_rm_check_lm(
-		struct sde_rm *rm,
-		struct sde_rm_rsvp *rsvp,
-		struct sde_rm_requirements *reqs,
-		const struct sde_lm_cfg *lm_cfg,
-		struct sde_rm_hw_blk *lm,
-		struct sde_rm_hw_blk **dspp,
-		struct sde_rm_hw_blk **ds,
-		struct sde_rm_hw_blk **pp)
+static void _sde_rm_get_graph_req(struct sde_rm_requirements *reqs,
+		struct sde_rm_graph_req *req)
 {
-	bool is_valid_dspp, is_valid_ds, ret = true;
-
-	is_valid_dspp = (lm_cfg->dspp != DSPP_MAX) ? true : false;
-	is_valid_ds = (lm_cfg->ds != DS_MAX) ? true : false;
-
-	/**
-	 * RM_RQ_X: specification of which LMs to choose
-	 * is_valid_X: indicates whether LM is tied with block X
-	 * ret: true if given LM matches the user requirement,
-	 *      false otherwise
-	 */
-	if (RM_RQ_DSPP(reqs) && RM_RQ_DS(reqs))
-		ret = (is_valid_dspp && is_valid_ds);
-	else if (RM_RQ_DSPP(reqs))
-		ret = is_valid_dspp;
-	else if (RM_RQ_DS(reqs))
-		ret = is_valid_ds;
-
-	if (!ret) {
-		SDE_DEBUG(
-			"fail:lm(%d)req_dspp(%d)dspp(%d)req_ds(%d)ds(%d)\n",
-			lm_cfg->id, (bool)(RM_RQ_DSPP(reqs)),
-			lm_cfg->dspp, (bool)(RM_RQ_DS(reqs)),
-			lm_cfg->ds);
-
-		return ret;
-	}
-	return true;
+	struct msm_compression_info *comp_info = reqs->hw_res.comp_info;
+
+	memset(req, 0, sizeof(*req));
+
+	req->num_lm = reqs->topology->num_lm;
+	req->num_ctl = reqs->topology->num_ctl;
+	req->num_dsc = reqs->topology->num_comp_enc;
+	req->dspp = RM_RQ_DSPP(reqs);
+	req->ds = RM_RQ_DS(reqs);
+	req->cwb = RM_RQ_CWB(reqs);
+	req->ppsplit = reqs->topology->top_name == SDE_RM_TOPOLOGY_PPSPLIT;
+	req->split_display = reqs->topology->needs_split_display;
+	req->primary = reqs->hw_res.display_type == SDE_CONNECTOR_PRIMARY;
+	req->secondary = reqs->hw_res.display_type == SDE_CONNECTOR_SECONDARY;
+	req->conn_lm_mask = reqs->conn_lm_mask;
+
+	if (comp_info && comp_info->comp_type == MSM_DISPLAY_COMPRESSION_DSC)
+		req->native_422_420 = comp_info->dsc_info.config.native_422 ||
+				comp_info->dsc_info.config.native_420;
 }
 
-static bool _sde_rm_reserve_dspp(
-		struct sde_rm *rm,
-		struct sde_rm_rsvp *rsvp,
-		const struct sde_lm_cfg *lm_cfg,
-		struct sde_rm_hw_blk *lm,
-		struct sde_rm_hw_blk **dspp)
-{
-	struct sde_rm_hw_iter iter;
-
-	if (lm_cfg->dspp != DSPP_MAX) {
-		sde_rm_init_hw_iter(&iter, 0, SDE_HW_BLK_DSPP);
-		while (_sde_rm_get_hw_locked(rm, &iter)) {
-			if (iter.blk->id == lm_cfg->dspp) {
-				*dspp = iter.blk;
-				break;
-			}
-		}
-
-		if (!*dspp) {
-			SDE_DEBUG("lm %d failed to retrieve dspp %d\n", lm->id,
-					lm_cfg->dspp);
-			return false;
-		}
-
-		if (RESERVED_BY_OTHER(*dspp, rsvp)) {
-			SDE_DEBUG("lm %d dspp %d already reserved\n",
-					lm->id, (*dspp)->id);
-			return false;
-		}
-	}
-
-	return true;
-}
-
-
-static bool _sde_rm_reserve_ds(
-		struct sde_rm *rm,
-		struct sde_rm_rsvp *rsvp,
-		const struct sde_lm_cfg *lm_cfg,
-		struct sde_rm_hw_blk *lm,
-		struct sde_rm_hw_blk **ds)
-{
-	struct sde_rm_hw_iter iter;
-
-	if (lm_cfg->ds != DS_MAX) {
-		sde_rm_init_hw_iter(&iter, 0, SDE_HW_BLK_DS);
-		while (_sde_rm_get_hw_locked(rm, &iter)) {
-			if (iter.blk->id == lm_cfg->ds) {
-				*ds = iter.blk;
-				break;
-			}
-		}
-
-		if (!*ds) {
-			SDE_DEBUG("lm %d failed to retrieve ds %d\n", lm->id,
-					lm_cfg->ds);
-			return false;
-		}
-
-		if (RESERVED_BY_OTHER(*ds, rsvp)) {
-			SDE_DEBUG("lm %d ds %d already reserved\n",
-					lm->id, (*ds)->id);
-			return false;
-		}
-	}
-
-	return true;
-}
-
-static bool _sde_rm_reserve_pp(
-		struct sde_rm *rm,
-		struct sde_rm_rsvp *rsvp,
-		struct sde_rm_requirements *reqs,
-		const struct sde_lm_cfg *lm_cfg,
-		const struct sde_pingpong_cfg *pp_cfg,
-		struct sde_rm_hw_blk *lm,
-		struct sde_rm_hw_blk **dspp,
-		struct sde_rm_hw_blk **ds,
-		struct sde_rm_hw_blk **pp)
+/**
+ * _sde_rm_tag_blk - tag a block with the reservation being created
+ * @rsvp: reservation currently being created
+ * @blk: block to tag
+ */
+static void _sde_rm_tag_blk(struct sde_rm_rsvp *rsvp,
+		struct sde_rm_hw_blk *blk)
 {
-	struct sde_rm_hw_iter iter;
-
-	sde_rm_init_hw_iter(&iter, 0, SDE_HW_BLK_PINGPONG);
-	while (_sde_rm_get_hw_locked(rm, &iter)) {
-		if (iter.blk->id == lm_cfg->pingpong) {
-			*pp = iter.blk;
-			break;
-		}
-	}
-
-	if (!*pp) {
-		SDE_ERROR("failed to get pp on lm %d\n", lm_cfg->pingpong);
-		return false;
-	}
-
-	if (RESERVED_BY_OTHER(*pp, rsvp)) {
-		SDE_DEBUG("lm %d pp %d already reserved\n", lm->id,
-				(*pp)->id);
-		*dspp = NULL;
-		*ds = NULL;
-		return false;
-	}
-
-	pp_cfg = to_sde_hw_pingpong((*pp)->hw)->caps;
-	if ((reqs->topology->top_name == SDE_RM_TOPOLOGY_PPSPLIT) &&
-			!(test_bit(SDE_PINGPONG_SPLIT, &pp_cfg->features))) {
-		SDE_DEBUG("pp %d doesn't support ppsplit\n", pp_cfg->id);
-		*dspp = NULL;
-		*ds = NULL;
-		return false;
-	}
-	return true;
+	blk->rsvp_nxt = rsvp;
+	if (blk->id < SDE_RM_GRAPH_MAX_ID)
+		__set_bit(blk->id, &rsvp->blks[blk->type]);
 }
 
 /**
- * _sde_rm_check_lm_and_get_connected_blks - check if proposed layer mixer meets
- *	proposed use case requirements, incl. hardwired dependent blocks like
- *	pingpong, and dspp.
+ * _sde_rm_update_taken_masks - collect the blocks held by other displays
+ *	from the committed blocks and the pending reservations, the graph picks
+ *	blocks for the reservation from the rest
  * @rm: sde resource manager handle
  * @rsvp: reservation currently being created
- * @reqs: proposed use case requirements
- * @lm: proposed layer mixer, function checks if lm, and all other hardwired
- *      blocks connected to the lm (pp, dspp) are available and appropriate
- * @dspp: output parameter, dspp block attached to the layer mixer.
- *        NULL if dspp was not available, or not matching requirements.
- * @pp: output parameter, pingpong block attached to the layer mixer.
- *      NULL if dspp was not available, or not matching requirements.
- * @primary_lm: if non-null, this function check if lm is compatible primary_lm
- *              as well as satisfying all other requirements
- * @Return: true if lm matches all requirements, false otherwise
  */
-static bool _sde_rm_check_lm_and_get_connected_blks(
-		struct sde_rm *rm,
-		struct sde_rm_rsvp *rsvp,
-		struct sde_rm_requirements *reqs,
-		struct sde_rm_hw_blk *lm,
-		struct sde_rm_hw_blk **dspp,
-		struct sde_rm_hw_blk **ds,
-		struct sde_rm_hw_blk **pp,
-		struct sde_rm_hw_blk *primary_lm,
-		u32 conn_lm_mask)
+static void _sde_rm_update_taken_masks(struct sde_rm *rm,
+		struct sde_rm_rsvp *rsvp)
 {
-	const struct sde_lm_cfg *lm_cfg = to_sde_hw_mixer(lm->hw)->cap;
-	const struct sde_pingpong_cfg *pp_cfg;
-	bool ret, is_conn_primary, is_conn_secondary;
-	u32 lm_primary_pref, lm_secondary_pref, cwb_pref;
-
-	*dspp = NULL;
-	*ds = NULL;
-	*pp = NULL;
-
-	lm_primary_pref = lm_cfg->features & BIT(SDE_DISP_PRIMARY_PREF);
-	lm_secondary_pref = lm_cfg->features & BIT(SDE_DISP_SECONDARY_PREF);
-	cwb_pref = lm_cfg->features & BIT(SDE_DISP_CWB_PREF);
-	is_conn_primary = (reqs->hw_res.display_type ==
-				 SDE_CONNECTOR_PRIMARY) ? true : false;
-	is_conn_secondary = (reqs->hw_res.display_type ==
-				 SDE_CONNECTOR_SECONDARY) ? true : false;
-
-	SDE_DEBUG("check lm %d: dspp %d ds %d pp %d features %d disp type %d\n",
-		 lm_cfg->id, lm_cfg->dspp, lm_cfg->ds, lm_cfg->pingpong,
-		 lm_cfg->features, (int)reqs->hw_res.display_type);
-
-	if (!RM_RQ_CWB(reqs) && (lm_cfg->features & BIT(SDE_MIXER_IS_VIRTUAL))) {
-		SDE_DEBUG("lm %d is a virtual mixer and use case is not CWB",
-				lm_cfg->id);
-		return false;
-	}
-
-	/* Check if this layer mixer is a peer of the proposed primary LM */
-	if (primary_lm) {
-		const struct sde_lm_cfg *prim_lm_cfg =
-				to_sde_hw_mixer(primary_lm->hw)->cap;
-
-		if (!test_bit(lm_cfg->id, &prim_lm_cfg->lm_pair_mask)) {
-			SDE_DEBUG("lm %d not peer of lm %d\n", lm_cfg->id,
-					prim_lm_cfg->id);
-			return false;
-		}
-	}
-
-	/* bypass rest of the checks if LM for primary display is found */
-	if (!lm_primary_pref && !lm_secondary_pref) {
-		/* Check lm for valid requirements */
-		ret = _sde_rm_check_lm(rm, rsvp, reqs, lm_cfg, lm,
-				dspp, ds, pp);
-		if (!ret)
-			return ret;
+	struct sde_rm_rsvp *r;
+	enum sde_hw_blk_type type;
 
-		/**
-		 * If CWB is enabled and LM is not CWB supported
-		 * then return false.
-		 */
-		if (RM_RQ_CWB(reqs) && !cwb_pref) {
-			SDE_DEBUG("fail: cwb supported lm not allocated\n");
-			return false;
-		}
+	memcpy(rm->taken, rm->busy, sizeof(rm->taken));
 
-		if (lm_cfg->cwb_mask && RM_RQ_CWB(reqs) &&
-			!(BIT(ffs(conn_lm_mask) - 1) & lm_cfg->cwb_mask)) {
-			SDE_DEBUG("cwb mixer not compatible id:%d cwb_mask:0x%x lm_mask:0x%x\n",
-					lm_cfg->id, lm_cfg->cwb_mask, conn_lm_mask);
-			return false;
+	/* blocks never overlap between reservations of different displays */
+	list_for_each_entry(r, &rm->rsvps, list) {
+		for (type = 0; type < SDE_HW_BLK_MAX; type++) {
+			if (r->enc_id == rsvp->enc_id && !r->pending)
+				rm->taken[type] &= ~r->blks[type];
+			else if (r->enc_id != rsvp->enc_id && r->pending)
+				rm->taken[type] |= r->blks[type];
 		}
-	} else if ((!is_conn_primary && lm_primary_pref) ||
-			(!is_conn_secondary && lm_secondary_pref)) {
-		SDE_DEBUG(
-			"display preference is not met. display_type: %d lm_features: %x\n",
-			(int)reqs->hw_res.display_type, lm_cfg->features);
-		return false;
 	}
-
-	/* Already reserved? */
-	if (RESERVED_BY_OTHER(lm, rsvp)) {
-		SDE_DEBUG("lm %d already reserved\n", lm_cfg->id);
-		return false;
-	}
-
-	/* Reserve dspp */
-	ret = _sde_rm_reserve_dspp(rm, rsvp, lm_cfg, lm, dspp);
-	if (!ret)
-		return ret;
-
-	/* Reserve ds */
-	ret = _sde_rm_reserve_ds(rm, rsvp, lm_cfg, lm, ds);
-	if (!ret)
-		return ret;
-
-	/* Reserve pp */
-	ret = _sde_rm_reserve_pp(rm, rsvp, reqs, lm_cfg, pp_cfg, lm,
-			dspp, ds, pp);
-	if (!ret)
-		return ret;
-
-	return true;
 }
 
 static int _sde_rm_reserve_lms(
@@ -1088,141 +918,60 @@ static int _sde_rm_reserve_lms(
 		u8 *_lm_ids)
 
 {
-	struct sde_rm_hw_blk *lm[MAX_BLOCKS];
-	struct sde_rm_hw_blk *dspp[MAX_BLOCKS];
-	struct sde_rm_hw_blk *ds[MAX_BLOCKS];
-	struct sde_rm_hw_blk *pp[MAX_BLOCKS];
-	struct sde_rm_hw_iter iter_i, iter_j;
-	u32 lm_mask = 0, conn_lm_mask = 0;
-	int lm_count = 0;
-	int i, rc = 0;
+	struct sde_rm_graph_req req;
+	struct sde_rm_hw_blk *lm, *pp, *dspp, *ds;
+	u8 lm_ids[LM_MAX];
+	int lm_count, pp_id, i;
 
 	if (!reqs->topology->num_lm) {
 		SDE_DEBUG("invalid number of lm: %d\n", reqs->topology->num_lm);
 		return 0;
 	}
 
-	if (RM_RQ_CWB(reqs))
-		conn_lm_mask = reqs->conn_lm_mask;
-
-	/* Find a primary mixer */
-	sde_rm_init_hw_iter(&iter_i, 0, SDE_HW_BLK_LM);
-	while (lm_count != reqs->topology->num_lm &&
-			_sde_rm_get_hw_locked(rm, &iter_i)) {
-		if (lm_mask & (1 << iter_i.blk->id))
-			continue;
-
-		lm[lm_count] = iter_i.blk;
-		dspp[lm_count] = NULL;
-		ds[lm_count] = NULL;
-		pp[lm_count] = NULL;
-
-		SDE_DEBUG("blk id = %d, _lm_ids[%d] = %d\n",
-			iter_i.blk->id,
-			lm_count,
-			_lm_ids ? _lm_ids[lm_count] : -1);
-
-		if (_lm_ids && (lm[lm_count])->id != _lm_ids[lm_count])
-			continue;
-
-		if (!_sde_rm_check_lm_and_get_connected_blks(
-				rm, rsvp, reqs, lm[lm_count],
-				&dspp[lm_count], &ds[lm_count],
-				&pp[lm_count], NULL, conn_lm_mask))
-			continue;
-
-		lm_mask |= (1 << iter_i.blk->id);
-		++lm_count;
-
-		if (RM_RQ_CWB(reqs))
-			conn_lm_mask = conn_lm_mask & ~BIT(ffs(conn_lm_mask) - 1);
-
-		/* Return if peer is not needed */
-		if (lm_count == reqs->topology->num_lm)
-			break;
+	_sde_rm_get_graph_req(reqs, &req);
+	req.lm_ids = _lm_ids;
 
-		/* Valid primary mixer found, find matching peers */
-		sde_rm_init_hw_iter(&iter_j, 0, SDE_HW_BLK_LM);
-
-		while (_sde_rm_get_hw_locked(rm, &iter_j)) {
-			if (lm_mask & (1 << iter_j.blk->id))
-				continue;
-
-			lm[lm_count] = iter_j.blk;
-			dspp[lm_count] = NULL;
-			ds[lm_count] = NULL;
-			pp[lm_count] = NULL;
-
-			if (!_sde_rm_check_lm_and_get_connected_blks(
-					rm, rsvp, reqs, iter_j.blk,
-					&dspp[lm_count], &ds[lm_count],
-					&pp[lm_count], iter_i.blk, conn_lm_mask))
-				continue;
-
-			SDE_DEBUG("blk id = %d, _lm_ids[%d] = %d\n",
-				iter_j.blk->id,
-				lm_count,
-				_lm_ids ? _lm_ids[lm_count] : -1);
-
-			if (_lm_ids && (lm[lm_count])->id != _lm_ids[lm_count])
-				continue;
-
-			lm_mask |= (1 << iter_j.blk->id);
-			++lm_count;
-
-			if (RM_RQ_CWB(reqs))
-				conn_lm_mask = conn_lm_mask & ~BIT(ffs(conn_lm_mask) - 1);
-
-			break;
-		}
-
-		/* Rollback primary LM if peer is not found */
-		if (!iter_j.hw) {
-			lm_mask &= ~(1 << iter_i.blk->id);
-			--lm_count;
-		}
-	}
-
-	if (lm_count != reqs->topology->num_lm) {
+	lm_count = sde_rm_graph_pick_lms(&rm->graph, &req, rm->taken, lm_ids);
+	if (lm_count < 0) {
 		SDE_DEBUG("unable to find appropriate mixers\n");
 		return -ENAVAIL;
 	}
 
 	for (i = 0; i < lm_count; i++) {
-		lm[i]->rsvp_nxt = rsvp;
-		pp[i]->rsvp_nxt = rsvp;
-		if (dspp[i])
-			dspp[i]->rsvp_nxt = rsvp;
+		const struct sde_lm_cfg *lm_cfg;
 
-		if (ds[i])
-			ds[i]->rsvp_nxt = rsvp;
+		lm = rm->blk_map[SDE_HW_BLK_LM][lm_ids[i]];
+		lm_cfg = to_sde_hw_mixer(lm->hw)->cap;
 
-		SDE_EVT32(lm[i]->type, rsvp->enc_id, lm[i]->id, pp[i]->id,
-				dspp[i] ? dspp[i]->id : 0,
-				ds[i] ? ds[i]->id : 0);
+		pp = rm->blk_map[SDE_HW_BLK_PINGPONG][lm_cfg->pingpong];
+		dspp = (lm_cfg->dspp != DSPP_MAX) ?
+			rm->blk_map[SDE_HW_BLK_DSPP][lm_cfg->dspp] : NULL;
+		ds = (lm_cfg->ds != DS_MAX) ?
+			rm->blk_map[SDE_HW_BLK_DS][lm_cfg->ds] : NULL;
+
+		_sde_rm_tag_blk(rsvp, lm);
+		_sde_rm_tag_blk(rsvp, pp);
+		if (dspp)
+			_sde_rm_tag_blk(rsvp, dspp);
+
+		if (ds)
+			_sde_rm_tag_blk(rsvp, ds);
+
+		SDE_EVT32(lm->type, rsvp->enc_id, lm->id, pp->id,
+				dspp ? dspp->id : 0,
+				ds ? ds->id : 0);
 	}
 
 	if (reqs->topology->top_name == SDE_RM_TOPOLOGY_PPSPLIT) {
 		/* reserve a free PINGPONG_SLAVE block */
-		rc = -ENAVAIL;
-		sde_rm_init_hw_iter(&iter_i, 0, SDE_HW_BLK_PINGPONG);
-		while (_sde_rm_get_hw_locked(rm, &iter_i)) {
-			const struct sde_hw_pingpong *pp =
-					to_sde_hw_pingpong(iter_i.blk->hw);
-			const struct sde_pingpong_cfg *pp_cfg = pp->caps;
-
-			if (!(test_bit(SDE_PINGPONG_SLAVE, &pp_cfg->features)))
-				continue;
-			if (RESERVED_BY_OTHER(iter_i.blk, rsvp))
-				continue;
+		pp_id = sde_rm_graph_pick_pp_slave(&rm->graph, rm->taken);
+		if (pp_id < 0)
+			return -ENAVAIL;
 
-			iter_i.blk->rsvp_nxt = rsvp;
-			rc = 0;
-			break;
-		}
+		_sde_rm_tag_blk(rsvp, rm->blk_map[SDE_HW_BLK_PINGPONG][pp_id]);
 	}
 
-	return rc;
+	return 0;
 }
 
 static int _sde_rm_reserve_ctls(
@@ -1232,123 +981,36 @@ static int _sde_rm_reserve_ctls(
 		const struct sde_rm_topology_def *top,
 		u8 *_ctl_ids)
 {
-	struct sde_rm_hw_blk *ctls[MAX_BLOCKS];
-	struct sde_rm_hw_iter iter;
-	int i = 0;
+	struct sde_rm_graph_req req;
+	struct sde_rm_hw_blk *ctl;
+	u8 ctl_ids[CTL_MAX];
+	int ctl_count, i;
 
 	if (!top->num_ctl) {
 		SDE_DEBUG("invalid number of ctl: %d\n", top->num_ctl);
 		return 0;
 	}
 
-	memset(&ctls, 0, sizeof(ctls));
-
-	sde_rm_init_hw_iter(&iter, 0, SDE_HW_BLK_CTL);
-	while (_sde_rm_get_hw_locked(rm, &iter)) {
-		const struct sde_hw_ctl *ctl = to_sde_hw_ctl(iter.blk->hw);
-		unsigned long features = ctl->caps->features;
-		bool has_split_display, has_ppsplit, primary_pref, secondary_pref;
-		bool is_conn_primary, is_conn_secondary;
-
-		if (RESERVED_BY_OTHER(iter.blk, rsvp))
-			continue;
-
-		has_split_display = BIT(SDE_CTL_SPLIT_DISPLAY) & features;
-		has_ppsplit = BIT(SDE_CTL_PINGPONG_SPLIT) & features;
-		primary_pref = BIT(SDE_CTL_PRIMARY_PREF) & features;
-		secondary_pref = BIT(SDE_CTL_SECONDARY_PREF) & features;
-		is_conn_primary = (reqs->hw_res.display_type ==
-					SDE_CONNECTOR_PRIMARY) ? true : false;
-		is_conn_secondary = (reqs->hw_res.display_type ==
-					SDE_CONNECTOR_SECONDARY) ? true : false;
-
-		SDE_DEBUG("ctl %d caps 0x%lX\n", iter.blk->id, features);
-
-		/*
-		 * bypass rest feature checks on finding CTL preferred
-		 * for primary displays.
-		 */
-		if (!primary_pref && !secondary_pref && !_ctl_ids) {
-			if (top->needs_split_display != has_split_display)
-				continue;
-
-			if (top->top_name == SDE_RM_TOPOLOGY_PPSPLIT &&
-					!has_ppsplit)
-				continue;
-
-			if (is_conn_primary || is_conn_secondary)
-				continue;
-		} else if (!((is_conn_primary && primary_pref) ||
-				(is_conn_secondary && secondary_pref)) && !_ctl_ids) {
-			SDE_DEBUG(
-				"display pref not met. display_type: %d features: 0x%lX\n",
-				reqs->hw_res.display_type, features);
-			continue;
-		}
-
-		ctls[i] = iter.blk;
-
-		SDE_DEBUG("blk id = %d, _ctl_ids[%d] = %d\n",
-			iter.blk->id, i,
-			_ctl_ids ? _ctl_ids[i] : -1);
-
-		if (_ctl_ids && (ctls[i]->id != _ctl_ids[i]))
-			continue;
-
-		SDE_DEBUG("ctl %d match\n", iter.blk->id);
+	_sde_rm_get_graph_req(reqs, &req);
+	req.num_ctl = top->num_ctl;
+	req.split_display = top->needs_split_display;
+	req.ppsplit = top->top_name == SDE_RM_TOPOLOGY_PPSPLIT;
+	req.ctl_ids = _ctl_ids;
 
-		if (++i == top->num_ctl)
-			break;
-	}
-
-	if (i != top->num_ctl)
+	ctl_count = sde_rm_graph_pick_ctls(&rm->graph, &req, rm->taken,
+			ctl_ids);
+	if (ctl_count < 0)
 		return -ENAVAIL;
 
-	for (i = 0; i < ARRAY_SIZE(ctls) && i < top->num_ctl; i++) {
-		ctls[i]->rsvp_nxt = rsvp;
-		SDE_EVT32(ctls[i]->type, rsvp->enc_id, ctls[i]->id);
+	for (i = 0; i < ctl_count; i++) {
+		ctl = rm->blk_map[SDE_HW_BLK_CTL][ctl_ids[i]];
+		_sde_rm_tag_blk(rsvp, ctl);
+		SDE_EVT32(ctl->type, rsvp->enc_id, ctl->id);
 	}
 
 	return 0;
 }
 
-static bool _sde_rm_check_dsc(struct sde_rm *rm,
-		struct sde_rm_rsvp *rsvp,
-		struct sde_rm_hw_blk *dsc,
-		struct sde_rm_hw_blk *paired_dsc,
-		struct sde_rm_hw_blk *pp_blk)
-{
-	const struct sde_dsc_cfg *dsc_cfg = to_sde_hw_dsc(dsc->hw)->caps;
-
-	/* Already reserved? */
-	if (RESERVED_BY_OTHER(dsc, rsvp)) {
-		SDE_DEBUG("dsc %d already reserved\n", dsc_cfg->id);
-		return false;
-	}
-
-	/**
-	 * This check is required for routing even numbered DSC
-	 * blks to any of the even numbered PP blks and odd numbered
-	 * DSC blks to any of the odd numbered PP blks.
-	 */
-	if (!pp_blk || !IS_COMPATIBLE_PP_DSC(pp_blk->id, dsc->id))
-		return false;
-
-	/* Check if this dsc is a peer of the proposed paired DSC */
-	if (paired_dsc) {
-		const struct sde_dsc_cfg *paired_dsc_cfg =
-				to_sde_hw_dsc(paired_dsc->hw)->caps;
-
-		if (!test_bit(dsc_cfg->id, paired_dsc_cfg->dsc_pair_mask)) {
-			SDE_DEBUG("dsc %d not peer of dsc %d\n", dsc_cfg->id,
-					paired_dsc_cfg->id);
-			return false;
-		}
-	}
-
-	return true;
-}
-
 static bool _sde_rm_check_vdc(struct sde_rm *rm,
 		struct sde_rm_rsvp *rsvp,
 		struct sde_rm_hw_blk *vdc)
@@ -1364,34 +1026,16 @@ static bool _sde_rm_check_vdc(struct sde_rm *rm,
 	return true;
 }
 
-static void sde_rm_get_rsvp_nxt_hw_blks(
-		struct sde_rm *rm,
-		struct sde_rm_rsvp *rsvp,
-		int type,
-		struct sde_rm_hw_blk **blk_arr)
-{
-	struct sde_rm_hw_blk *blk;
-	int i = 0;
-
-	list_for_each_entry(blk, &rm->hw_blks[type], list) {
-		if (blk->rsvp_nxt && blk->rsvp_nxt->seq ==
-					rsvp->seq)
-			blk_arr[i++] = blk;
-	}
-}
-
 static int _sde_rm_reserve_dsc(
 		struct sde_rm *rm,
 		struct sde_rm_rsvp *rsvp,
 		struct sde_rm_requirements *reqs,
 		u8 *_dsc_ids)
 {
-	struct sde_rm_hw_iter iter_i, iter_j;
-	struct sde_rm_hw_blk *dsc[MAX_BLOCKS];
-	u32 reserve_mask = 0;
-	struct sde_rm_hw_blk *pp[MAX_BLOCKS];
-	int alloc_count = 0;
-	int num_dsc_enc;
+	struct sde_rm_graph_req req;
+	struct sde_rm_hw_blk *blk;
+	u8 pp_ids[PINGPONG_MAX], dsc_ids[DSC_MAX];
+	int num_dsc_enc, alloc_count, num_pp = 0;
 	struct msm_display_dsc_info *dsc_info;
 	int i;
 
@@ -1409,90 +1053,29 @@ static int _sde_rm_reserve_dsc(
 		return 0;
 	}
 
-	sde_rm_init_hw_iter(&iter_i, 0, SDE_HW_BLK_DSC);
-	sde_rm_get_rsvp_nxt_hw_blks(rm, rsvp, SDE_HW_BLK_PINGPONG, pp);
-
-	/* Find a first DSC */
-	while (alloc_count != num_dsc_enc &&
-			_sde_rm_get_hw_locked(rm, &iter_i)) {
-		const struct sde_hw_dsc *hw_dsc = to_sde_hw_dsc(
-				iter_i.blk->hw);
-		unsigned long features = hw_dsc->caps->features;
-		bool has_422_420_support =
-			BIT(SDE_DSC_NATIVE_422_EN) & features;
-
-		if (reserve_mask & (1 << iter_i.blk->id))
-			continue;
-
-		if (_dsc_ids && (iter_i.blk->id != _dsc_ids[alloc_count]))
-			continue;
-
-		/* if this hw block does not support required feature */
-		if (!_dsc_ids && (dsc_info->config.native_422 ||
-			dsc_info->config.native_420) && !has_422_420_support)
-			continue;
-
-		if (!_sde_rm_check_dsc(rm, rsvp, iter_i.blk, NULL,
-					 pp[alloc_count]))
-			continue;
-
-		SDE_DEBUG("blk id = %d, _dsc_ids[%d] = %d\n",
-			iter_i.blk->id,
-			alloc_count,
-			_dsc_ids ? _dsc_ids[alloc_count] : -1);
-
-		reserve_mask |= (1 << iter_i.blk->id);
-		dsc[alloc_count++] = iter_i.blk;
-
-		/* Return if peer is not needed */
-		if (alloc_count == num_dsc_enc)
-			break;
-
-		/* Valid first dsc found, find matching peers */
-		sde_rm_init_hw_iter(&iter_j, 0, SDE_HW_BLK_DSC);
-
-		while (_sde_rm_get_hw_locked(rm, &iter_j)) {
-			if (reserve_mask & (1 << iter_j.blk->id))
-				continue;
-
-			if (_dsc_ids && (iter_j.blk->id !=
-					_dsc_ids[alloc_count]))
-				continue;
-
-			if (!_sde_rm_check_dsc(rm, rsvp, iter_j.blk,
-					 iter_i.blk, pp[alloc_count]))
-				continue;
-
-			SDE_DEBUG("blk id = %d, _dsc_ids[%d] = %d\n",
-				iter_j.blk->id,
-				alloc_count,
-				_dsc_ids ? _dsc_ids[alloc_count] : -1);
-
-			reserve_mask |= (1 << iter_j.blk->id);
-			dsc[alloc_count++] = iter_j.blk;
-			break;
-		}
-
-		/* Rollback primary DSC if peer is not found */
-		if (!iter_j.hw) {
-			reserve_mask &= ~(1 << iter_i.blk->id);
-			--alloc_count;
-		}
+	/* pingpongs of this reservation, dsc blocks are routed by their id */
+	for (i = 0; i < PINGPONG_MAX; i++) {
+		blk = rm->blk_map[SDE_HW_BLK_PINGPONG][i];
+		if (blk && blk->rsvp_nxt == rsvp)
+			pp_ids[num_pp++] = i;
 	}
 
-	if (alloc_count != num_dsc_enc) {
+	_sde_rm_get_graph_req(reqs, &req);
+	req.dsc_ids = _dsc_ids;
+
+	alloc_count = sde_rm_graph_pick_dscs(&rm->graph, &req, rm->taken,
+			pp_ids, num_pp, dsc_ids);
+	if (alloc_count < 0) {
 		SDE_ERROR("couldn't reserve %d dsc blocks for enc id %d\n",
 			num_dsc_enc, rsvp->enc_id);
 		return -EINVAL;
 	}
 
 	for (i = 0; i < alloc_count; i++) {
-		if (!dsc[i])
-			break;
+		blk = rm->blk_map[SDE_HW_BLK_DSC][dsc_ids[i]];
+		_sde_rm_tag_blk(rsvp, blk);
 
-		dsc[i]->rsvp_nxt = rsvp;
-
-		SDE_EVT32(dsc[i]->type, rsvp->enc_id, dsc[i]->id);
+		SDE_EVT32(blk->type, rsvp->enc_id, blk->id);
 	}
 
 	return 0;
@@ -1550,7 +1133,7 @@ static int _sde_rm_reserve_vdc(
 		if (!vdc[i])
 			break;
 
-		vdc[i]->rsvp_nxt = rsvp;
+		_sde_rm_tag_blk(rsvp, vdc[i]);
 
 		SDE_EVT32(vdc[i]->type, rsvp->enc_id, vdc[i]->id);
 	}
@@ -1582,7 +1165,7 @@ static int _sde_rm_reserve_qdss(
 
 		SDE_DEBUG("blk id = %d\n", iter.blk->id);
 
-		iter.blk->rsvp_nxt = rsvp;
+		_sde_rm_tag_blk(rsvp, iter.blk);
 		SDE_EVT32(iter.blk->type, rsvp->enc_id, iter.blk->id);
 		return 0;
 	}
@@ -1625,7 +1208,7 @@ static int _sde_rm_reserve_cdm(
 		if (!match)
 			continue;
 
-		iter.blk->rsvp_nxt = rsvp;
+		_sde_rm_tag_blk(rsvp, iter.blk);
 		SDE_EVT32(iter.blk->type, rsvp->enc_id, iter.blk->id);
 		break;
 	}
@@ -1659,7 +1242,7 @@ static int _sde_rm_reserve_intf_or_wb(
 			return -ENAVAIL;
 		}
 
-		iter.blk->rsvp_nxt = rsvp;
+		_sde_rm_tag_blk(rsvp, iter.blk);
 		SDE_EVT32(iter.blk->type, rsvp->enc_id, iter.blk->id);
 		break;
 	}
@@ -1824,6 +1407,32 @@ static int _sde_rm_make_vdc_rsvp(struct sde_rm *rm, struct sde_rm_rsvp *rsvp,
 	return ret;
 }
 
+static void _sde_rm_get_rsvp_key(struct sde_rm_requirements *reqs,
+		struct sde_rm_rsvp_key *key)
+{
+	struct msm_compression_info *comp_info = reqs->hw_res.comp_info;
+
+	/* zero the padding too, keys are compared with memcmp */
+	memset(key, 0, sizeof(*key));
+
+	key->top_ctrl = reqs->top_ctrl;
+	key->topology = reqs->topology;
+	memcpy(key->intfs, reqs->hw_res.intfs, sizeof(key->intfs));
+	memcpy(key->wbs, reqs->hw_res.wbs, sizeof(key->wbs));
+	key->needs_cdm = reqs->hw_res.needs_cdm;
+	key->display_type = reqs->hw_res.display_type;
+	key->cwb_requested_disp_type = reqs->cwb_requested_disp_type;
+	key->conn_lm_mask = reqs->conn_lm_mask;
+
+	if (comp_info) {
+		key->comp_type = comp_info->comp_type;
+		if (comp_info->comp_type == MSM_DISPLAY_COMPRESSION_DSC)
+			key->native_422_420 =
+				comp_info->dsc_info.config.native_422 ||
+				comp_info->dsc_info.config.native_420;
+	}
+}
+
 static int _sde_rm_make_next_rsvp(struct sde_rm *rm, struct drm_encoder *enc,
 		struct drm_crtc_state *crtc_state,
 		struct drm_connector_state *conn_state,
@@ -1857,8 +1466,11 @@ static int _sde_rm_make_next_rsvp(struct sde_rm *rm, struct drm_encoder *enc,
 	rsvp->enc_id = enc->base.id;
 	rsvp->topology = reqs->topology->top_name;
 	rsvp->pending = true;
+	_sde_rm_get_rsvp_key(reqs, &rsvp->key);
 	list_add_tail(&rsvp->list, &rm->rsvps);
 
+	_sde_rm_update_taken_masks(rm, rsvp);
+
 	ret = _sde_rm_make_lm_rsvp(rm, rsvp, reqs, splash_display);
 	if (ret) {
 		SDE_ERROR("unable to find appropriate mixers\n");
@@ -2307,6 +1919,10 @@ static void _sde_rm_release_rsvp(
 		}
 	}
 
+	if (!rsvp->pending)
+		for (type = 0; type < SDE_HW_BLK_MAX; type++)
+			rm->busy[type] &= ~rsvp->blks[type];
+
 	for (type = 0; type < SDE_HW_BLK_MAX; type++) {
 		list_for_each_entry(blk, &rm->hw_blks[type], list) {
 			if (blk->rsvp == rsvp) {
@@ -2410,6 +2026,9 @@ static void _sde_rm_commit_rsvp(
 		}
 	}
 
+	for (type = 0; type < SDE_HW_BLK_MAX; type++)
+		rm->busy[type] |= rsvp->blks[type];
+
 	rsvp->pending = false;
 	SDE_DEBUG("rsrv enc %d topology %d\n", rsvp->enc_id, rsvp->topology);
 	SDE_EVT32(rsvp->enc_id, rsvp->topology);
@@ -2448,9 +2067,11 @@ int sde_rm_reserve(
 {
 	struct sde_rm_rsvp *rsvp_cur, *rsvp_nxt;
 	struct sde_rm_requirements reqs = {0,};
+	struct sde_rm_rsvp_key key;
 	struct msm_drm_private *priv;
 	struct sde_kms *sde_kms;
 	struct msm_compression_info *comp_info;
+	bool cont_splash;
 	int ret = 0;
 
 	if (!rm || !enc || !crtc_state || !conn_state) {
@@ -2470,8 +2091,8 @@ int sde_rm_reserve(
 	sde_kms = to_sde_kms(priv->kms);
 
 	/* Check if this is just a page-flip */
-	if (!_sde_rm_is_display_in_cont_splash(sde_kms, enc) &&
-			!drm_atomic_crtc_needs_modeset(crtc_state))
+	cont_splash = _sde_rm_is_display_in_cont_splash(sde_kms, enc);
+	if (!cont_splash && !drm_atomic_crtc_needs_modeset(crtc_state))
 		return 0;
 
 	comp_info = kzalloc(sizeof(*comp_info), GFP_KERNEL);
@@ -2523,6 +2144,23 @@ int sde_rm_reserve(
 		goto end;
 	}
 
+	/*
+	 * Mode switches that keep the topology (dfps, dms, poms) end up with
+	 * exactly the same blocks, keep the committed reservation instead of
+	 * building, checking and swapping in an identical one.
+	 */
+	_sde_rm_get_rsvp_key(&reqs, &key);
+	if (rsvp_cur && !rsvp_nxt && !cont_splash &&
+			!(test_only && RM_RQ_CLEAR(&reqs)) &&
+			!memcmp(&rsvp_cur->key, &key, sizeof(key))) {
+		rm->rsvp_reuse_cnt++;
+		SDE_DEBUG("reuse rsvp[s%de%d] test_only %d\n",
+				rsvp_cur->seq, rsvp_cur->enc_id, test_only);
+		SDE_EVT32(enc->base.id, rsvp_cur->seq, test_only,
+				rm->rsvp_reuse_cnt);
+		goto end;
+	}
+
 	/*
 	 * We only support one active reservation per-hw-block. But to implement
 	 * transactional semantics for test-only, and for allowing failure while
@@ -2637,6 +2275,11 @@ int sde_rm_ext_blk_create_reserve(struct sde_rm *rm,
 	blk->rsvp = rsvp;
 	list_add_tail(&blk->list, &rm->hw_blks[hw->type]);
 
+	if (blk->id < SDE_RM_GRAPH_MAX_ID) {
+		__set_bit(blk->id, &rsvp->blks[blk->type]);
+		__set_bit(blk->id, &rm->busy[blk->type]);
+	}
+
 	SDE_DEBUG("create blk %d %d for rsvp %d enc %d\n", blk->type, blk->id,
 					rsvp->seq, rsvp->enc_id);
 
@@ -2679,6 +2322,9 @@ int sde_rm_ext_blk_destroy(struct sde_rm *rm,
 		}
 	}
 
+	for (type = 0; type < SDE_HW_BLK_MAX; type++)
+		rm->busy[type] &= ~rsvp->blks[type];
+
 	SDE_DEBUG("del rsvp %d\n", rsvp->seq);
 	list_del(&rsvp->list);
 	kfree(rsvp);
@@ -10,6 +10,7 @@
 
 #include "msm_kms.h"
 #include "sde_hw_top.h"
+#include "sde_rm_graph.h"
 
 #define SINGLE_CTL	1
 #define DUAL_CTL	2
@@ -148,6 +149,12 @@ struct sde_rm_topology_def {
 	enum msm_display_compression_type comp_type;
 };
 
+/**
+ *  struct sde_rm_hw_blk - resource manager internal structure
+ *	forward declaration for single iterator definition without void pointer
+ */
+struct sde_rm_hw_blk;
+
 /**
  * struct sde_rm - SDE dynamic hardware resource manager
  * @dev: device handle for event logging purposes
@@ -159,6 +166,15 @@ struct sde_rm_topology_def {
  * @rsvp_next_seq: sequence number for next reservation for debugging purposes
  * @rm_lock: resource manager mutex
  * @avail_res: Pointer with curr available resources
+ * @rsvp_reuse_cnt: number of reservations satisfied by keeping the
+ *	committed reservation of the encoder
+ * @graph: compatibility of the lm/pp/dspp/ds/ctl/dsc blocks, built from the
+ *	catalog at init
+ * @blk_map: hw block tracking items indexed by block type and id
+ * @busy: per block type mask of the blocks of the committed reservations,
+ *	updated when a reservation is committed or released
+ * @taken: per block type mask of the blocks held by displays other than the
+ *	one being reserved, derived from @busy and the pending reservations
  */
 struct sde_rm {
 	struct drm_device *dev;
@@ -170,14 +186,13 @@ struct sde_rm {
 	struct mutex rm_lock;
 	const struct sde_rm_topology_def *topology_tbl;
 	struct msm_resource_caps_info avail_res;
+	u32 rsvp_reuse_cnt;
+	struct sde_rm_graph graph;
+	struct sde_rm_hw_blk *blk_map[SDE_HW_BLK_MAX][SDE_RM_GRAPH_MAX_ID];
+	unsigned long busy[SDE_HW_BLK_MAX];
+	unsigned long taken[SDE_HW_BLK_MAX];
 };
 
-/**
- *  struct sde_rm_hw_blk - resource manager internal structure
- *	forward declaration for single iterator definition without void pointer
- */
-struct sde_rm_hw_blk;
-
 /**
  * struct sde_rm_hw_iter - iterator for use with sde_rm
  * @hw: sde_hw object requested, or NULL on failure
@@ -214,6 +229,13 @@ enum sde_rm_topology_name sde_rm_get_topology_name(struct sde_rm *rm,
 		struct msm_display_topology topology);
 
 
+/**
+ * sde_rm_get_topology_table - get the topology table for a ctl version
+ * @ctl_rev: ctl path version from the catalog
+ * @Return: table of SDE_RM_TOPOLOGY_MAX topology definitions
+ */
+const struct sde_rm_topology_def *sde_rm_get_topology_table(u32 ctl_rev);
+
 /**
  * sde_rm_init - Read hardware catalog and create reservation tracking objects
  *	for all HW blocks.
@@ -0,0 +1,383 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#define pr_fmt(fmt)	"[drm:%s] " fmt, __func__
+#include <linux/bitops.h>
+#include <linux/errno.h>
+#include <linux/string.h>
+
+#include "sde_rm_graph.h"
+
+static inline bool _sde_rm_graph_has(unsigned long mask, u32 id, u32 max)
+{
+	return id < max && test_bit(id, &mask);
+}
+
+int sde_rm_graph_init(struct sde_rm_graph *graph,
+		const struct sde_mdss_cfg *cat)
+{
+	unsigned long dspp = 0, ds = 0, pp = 0, pp_split = 0;
+	int i;
+
+	BUILD_BUG_ON(LM_MAX > SDE_RM_GRAPH_MAX_ID);
+	BUILD_BUG_ON(DSPP_MAX > SDE_RM_GRAPH_MAX_ID);
+	BUILD_BUG_ON(DS_MAX > SDE_RM_GRAPH_MAX_ID);
+	BUILD_BUG_ON(PINGPONG_MAX > SDE_RM_GRAPH_MAX_ID);
+	BUILD_BUG_ON(CTL_MAX > SDE_RM_GRAPH_MAX_ID);
+	BUILD_BUG_ON(DSC_MAX > SDE_RM_GRAPH_MAX_ID);
+
+	if (!graph || !cat)
+		return -EINVAL;
+
+	memset(graph, 0, sizeof(*graph));
+
+	for (i = 0; i < cat->dspp_count; i++) {
+		if (cat->dspp[i].id >= DSPP_MAX)
+			return -EINVAL;
+		__set_bit(cat->dspp[i].id, &dspp);
+	}
+
+	/* dest scaler blocks are only managed when the mdp has them */
+	for (i = 0; cat->mdp[0].has_dest_scaler && i < cat->ds_count; i++) {
+		if (cat->ds[i].id >= DS_MAX)
+			return -EINVAL;
+		__set_bit(cat->ds[i].id, &ds);
+	}
+
+	for (i = 0; i < cat->pingpong_count; i++) {
+		const struct sde_pingpong_cfg *pp_cfg = &cat->pingpong[i];
+
+		if (pp_cfg->id >= PINGPONG_MAX)
+			return -EINVAL;
+		__set_bit(pp_cfg->id, &pp);
+		if (test_bit(SDE_PINGPONG_SPLIT, &pp_cfg->features))
+			__set_bit(pp_cfg->id, &pp_split);
+		if (test_bit(SDE_PINGPONG_SLAVE, &pp_cfg->features))
+			__set_bit(pp_cfg->id, &graph->pp_slave);
+	}
+
+	for (i = 0; i < cat->mixer_count; i++) {
+		const struct sde_lm_cfg *lm = &cat->mixer[i];
+		unsigned long bit;
+
+		if (lm->id >= LM_MAX)
+			return -EINVAL;
+		bit = BIT(lm->id);
+
+		/* a mixer is only usable along with its hardwired blocks */
+		if (!_sde_rm_graph_has(pp, lm->pingpong, PINGPONG_MAX))
+			continue;
+		if (lm->dspp != DSPP_MAX &&
+				!_sde_rm_graph_has(dspp, lm->dspp, DSPP_MAX))
+			continue;
+		if (lm->ds != DS_MAX && !_sde_rm_graph_has(ds, lm->ds, DS_MAX))
+			continue;
+
+		graph->lm |= bit;
+		graph->lm_peers[lm->id] = lm->lm_pair_mask;
+		graph->lm_cwb_mask[lm->id] = lm->cwb_mask;
+		graph->lm_pp[lm->id] = lm->pingpong;
+		graph->pp_lms[lm->pingpong] |= bit;
+
+		if (test_bit(lm->pingpong, &pp_split))
+			graph->lm_pp_split |= bit;
+
+		if (lm->dspp != DSPP_MAX) {
+			graph->lm_dspp |= bit;
+			graph->dspp_lms[lm->dspp] |= bit;
+		}
+
+		if (lm->ds != DS_MAX) {
+			graph->lm_ds |= bit;
+			graph->ds_lms[lm->ds] |= bit;
+		}
+
+		if (lm->features & BIT(SDE_MIXER_IS_VIRTUAL))
+			graph->lm_virtual |= bit;
+		if (lm->features & BIT(SDE_DISP_PRIMARY_PREF))
+			graph->lm_primary_pref |= bit;
+		if (lm->features & BIT(SDE_DISP_SECONDARY_PREF))
+			graph->lm_secondary_pref |= bit;
+		if (lm->features & BIT(SDE_DISP_CWB_PREF))
+			graph->lm_cwb_pref |= bit;
+	}
+
+	for (i = 0; i < cat->ctl_count; i++) {
+		const struct sde_ctl_cfg *ctl = &cat->ctl[i];
+		unsigned long bit;
+
+		if (ctl->id >= CTL_MAX)
+			return -EINVAL;
+		bit = BIT(ctl->id);
+
+		graph->ctl |= bit;
+		if (ctl->features & BIT(SDE_CTL_SPLIT_DISPLAY))
+			graph->ctl_split |= bit;
+		if (ctl->features & BIT(SDE_CTL_PINGPONG_SPLIT))
+			graph->ctl_ppsplit |= bit;
+		if (ctl->features & BIT(SDE_CTL_PRIMARY_PREF))
+			graph->ctl_primary_pref |= bit;
+		if (ctl->features & BIT(SDE_CTL_SECONDARY_PREF))
+			graph->ctl_secondary_pref |= bit;
+	}
+
+	for (i = 0; i < cat->dsc_count; i++) {
+		const struct sde_dsc_cfg *dsc = &cat->dsc[i];
+		unsigned long bit;
+
+		if (dsc->id >= DSC_MAX)
+			return -EINVAL;
+		bit = BIT(dsc->id);
+
+		graph->dsc |= bit;
+		graph->dsc_peers[dsc->id] = dsc->dsc_pair_mask[0];
+		if (dsc->features & BIT(SDE_DSC_NATIVE_422_EN))
+			graph->dsc_422 |= bit;
+		/* even dsc blocks route to even pingpongs, odd to odd */
+		if (!(dsc->id % 2))
+			graph->dsc_even |= bit;
+	}
+
+	return 0;
+}
+
+static unsigned long _sde_rm_graph_lm_candidates(
+		const struct sde_rm_graph *graph,
+		const struct sde_rm_graph_req *req,
+		const unsigned long *busy)
+{
+	unsigned long pref = graph->lm_primary_pref | graph->lm_secondary_pref;
+	unsigned long avail = graph->lm & ~busy[SDE_HW_BLK_LM];
+	unsigned long plain;
+	int id;
+
+	if (!req->cwb)
+		avail &= ~graph->lm_virtual;
+
+	/* mixers without a display preference have to meet the requests */
+	plain = avail & ~pref;
+	if (req->dspp)
+		plain &= graph->lm_dspp;
+	if (req->ds)
+		plain &= graph->lm_ds;
+	if (req->cwb)
+		plain &= graph->lm_cwb_pref;
+
+	/* preferred mixers only go to the display they are preferred for */
+	if (!req->primary)
+		avail &= ~graph->lm_primary_pref;
+	if (!req->secondary)
+		avail &= ~graph->lm_secondary_pref;
+	avail = plain | (avail & pref);
+
+	/* drop mixers whose hardwired blocks are held by another display */
+	for_each_set_bit(id, &busy[SDE_HW_BLK_DSPP], DSPP_MAX)
+		avail &= ~graph->dspp_lms[id];
+	for_each_set_bit(id, &busy[SDE_HW_BLK_DS], DS_MAX)
+		avail &= ~graph->ds_lms[id];
+	for_each_set_bit(id, &busy[SDE_HW_BLK_PINGPONG], PINGPONG_MAX)
+		avail &= ~graph->pp_lms[id];
+
+	if (req->ppsplit)
+		avail &= graph->lm_pp_split;
+
+	return avail;
+}
+
+static bool _sde_rm_graph_lm_cwb_ok(const struct sde_rm_graph *graph,
+		const struct sde_rm_graph_req *req, u32 id, u32 conn_lm_mask)
+{
+	u32 cwb_mask = graph->lm_cwb_mask[id];
+
+	if (!req->cwb || !cwb_mask ||
+			test_bit(id, &graph->lm_primary_pref) ||
+			test_bit(id, &graph->lm_secondary_pref))
+		return true;
+
+	/* the mixer must be muxed to the next mixer of the cwb source */
+	return conn_lm_mask && (BIT(ffs(conn_lm_mask) - 1) & cwb_mask);
+}
+
+int sde_rm_graph_pick_lms(const struct sde_rm_graph *graph,
+		const struct sde_rm_graph_req *req,
+		const unsigned long *busy, u8 *lm_ids)
+{
+	unsigned long avail, peers, picked = 0;
+	u32 conn_lm_mask = req->cwb ? req->conn_lm_mask : 0;
+	int count = 0, i, j;
+
+	if (!req->num_lm || req->num_lm > LM_MAX)
+		return -ENAVAIL;
+
+	avail = _sde_rm_graph_lm_candidates(graph, req, busy);
+
+	/* find a primary mixer, then a peer for it from its pair mask */
+	for_each_set_bit(i, &avail, LM_MAX) {
+		if (test_bit(i, &picked))
+			continue;
+
+		if (req->lm_ids && i != req->lm_ids[count])
+			continue;
+
+		if (!_sde_rm_graph_lm_cwb_ok(graph, req, i, conn_lm_mask))
+			continue;
+
+		__set_bit(i, &picked);
+		lm_ids[count++] = i;
+		conn_lm_mask &= conn_lm_mask - 1;
+
+		if (count == req->num_lm)
+			return count;
+
+		peers = avail & graph->lm_peers[i] & ~picked;
+		for_each_set_bit(j, &peers, LM_MAX) {
+			if (!_sde_rm_graph_lm_cwb_ok(graph, req, j,
+					conn_lm_mask))
+				continue;
+
+			if (!req->lm_ids || j == req->lm_ids[count])
+				break;
+		}
+
+		/* roll back the primary mixer if it has no peer */
+		if (j >= LM_MAX) {
+			__clear_bit(i, &picked);
+			--count;
+			continue;
+		}
+
+		__set_bit(j, &picked);
+		lm_ids[count++] = j;
+		conn_lm_mask &= conn_lm_mask - 1;
+
+		if (count == req->num_lm)
+			return count;
+	}
+
+	return -ENAVAIL;
+}
+
+int sde_rm_graph_pick_pp_slave(const struct sde_rm_graph *graph,
+		const unsigned long *busy)
+{
+	unsigned long avail = graph->pp_slave & ~busy[SDE_HW_BLK_PINGPONG];
+
+	return avail ? __ffs(avail) : -ENAVAIL;
+}
+
+int sde_rm_graph_pick_ctls(const struct sde_rm_graph *graph,
+		const struct sde_rm_graph_req *req,
+		const unsigned long *busy, u8 *ctl_ids)
+{
+	unsigned long pref = graph->ctl_primary_pref |
+			graph->ctl_secondary_pref;
+	unsigned long avail = graph->ctl & ~busy[SDE_HW_BLK_CTL];
+	unsigned long plain, preferred = 0;
+	int count = 0, i;
+
+	if (!req->num_ctl || req->num_ctl > CTL_MAX)
+		return -ENAVAIL;
+
+	/* ctl ids handed over by the bootloader bypass the feature checks */
+	if (!req->ctl_ids) {
+		plain = avail & ~pref;
+		if (req->split_display)
+			plain &= graph->ctl_split;
+		else
+			plain &= ~graph->ctl_split;
+		if (req->ppsplit)
+			plain &= graph->ctl_ppsplit;
+
+		/* primary and secondary displays only get their preferred ctl */
+		if (req->primary || req->secondary)
+			plain = 0;
+
+		if (req->primary)
+			preferred |= graph->ctl_primary_pref;
+		if (req->secondary)
+			preferred |= graph->ctl_secondary_pref;
+
+		avail = plain | (avail & preferred);
+	}
+
+	for_each_set_bit(i, &avail, CTL_MAX) {
+		if (req->ctl_ids && i != req->ctl_ids[count])
+			continue;
+
+		ctl_ids[count++] = i;
+		if (count == req->num_ctl)
+			return count;
+	}
+
+	return -ENAVAIL;
+}
+
+static unsigned long _sde_rm_graph_dsc_for_pp(
+		const struct sde_rm_graph *graph,
+		const u8 *pp_ids, u32 num_pp, int idx)
+{
+	if (idx >= num_pp)
+		return 0;
+
+	return (pp_ids[idx] % 2) ? graph->dsc & ~graph->dsc_even :
+			graph->dsc_even;
+}
+
+int sde_rm_graph_pick_dscs(const struct sde_rm_graph *graph,
+		const struct sde_rm_graph_req *req,
+		const unsigned long *busy, const u8 *pp_ids, u32 num_pp,
+		u8 *dsc_ids)
+{
+	unsigned long avail = graph->dsc & ~busy[SDE_HW_BLK_DSC];
+	unsigned long first, peers, picked = 0;
+	int count = 0, i, j;
+
+	if (!req->num_dsc || req->num_dsc > DSC_MAX)
+		return -ENAVAIL;
+
+	first = avail;
+	if (!req->dsc_ids && req->native_422_420)
+		first &= graph->dsc_422;
+
+	/* find a first dsc, then a peer for it from its pair mask */
+	for_each_set_bit(i, &first, DSC_MAX) {
+		if (test_bit(i, &picked))
+			continue;
+
+		if (req->dsc_ids && i != req->dsc_ids[count])
+			continue;
+
+		if (!(_sde_rm_graph_dsc_for_pp(graph, pp_ids, num_pp, count) &
+				BIT(i)))
+			continue;
+
+		__set_bit(i, &picked);
+		dsc_ids[count++] = i;
+
+		if (count == req->num_dsc)
+			return count;
+
+		peers = avail & graph->dsc_peers[i] & ~picked &
+			_sde_rm_graph_dsc_for_pp(graph, pp_ids, num_pp, count);
+		for_each_set_bit(j, &peers, DSC_MAX)
+			if (!req->dsc_ids || j == req->dsc_ids[count])
+				break;
+
+		/* roll back the first dsc if it has no peer */
+		if (j >= DSC_MAX) {
+			__clear_bit(i, &picked);
+			--count;
+			continue;
+		}
+
+		__set_bit(j, &picked);
+		dsc_ids[count++] = j;
+
+		if (count == req->num_dsc)
+			return count;
+	}
+
+	return -ENAVAIL;
+}
@@ -0,0 +1,172 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#ifndef _SDE_RM_GRAPH_H
+#define _SDE_RM_GRAPH_H
+
+#include <linux/types.h>
+
+#include "sde_hw_mdss.h"
+#include "sde_hw_catalog.h"
+
+/* ids of the blocks tracked by the graph all fit in one unsigned long */
+#define SDE_RM_GRAPH_MAX_ID	BITS_PER_LONG
+
+/**
+ * struct sde_rm_graph - compatibility of the layer mixer paths, resolved once
+ *	from the catalog. Every mask is indexed by block id, so a reservation
+ *	only has to combine these with the masks of blocks held by other
+ *	displays.
+ * @lm:			usable layer mixers, i.e. present in the catalog
+ *			along with every block hardwired to them
+ * @lm_peers:		per mixer, mixers that can be paired with it
+ * @lm_dspp:		mixers with a hardwired dspp
+ * @lm_ds:		mixers with a hardwired dest scaler
+ * @lm_pp_split:	mixers whose pingpong supports pp split
+ * @lm_virtual:		virtual mixers, only usable for cwb
+ * @lm_primary_pref:	mixers preferred for the primary display
+ * @lm_secondary_pref:	mixers preferred for the secondary display
+ * @lm_cwb_pref:	mixers preferred for cwb
+ * @lm_cwb_mask:	per mixer, cwb_mask of the mixer catalog entry
+ * @lm_pp:		per mixer, id of the hardwired pingpong
+ * @dspp_lms:		per dspp, mixers hardwired to it
+ * @ds_lms:		per dest scaler, mixers hardwired to it
+ * @pp_lms:		per pingpong, mixers hardwired to it
+ * @pp_slave:		pingpongs usable as pp split slave
+ * @ctl:		ctl paths present in the catalog
+ * @ctl_split:		ctl paths supporting split display
+ * @ctl_ppsplit:	ctl paths supporting pp split
+ * @ctl_primary_pref:	ctl paths preferred for the primary display
+ * @ctl_secondary_pref:	ctl paths preferred for the secondary display
+ * @dsc:		dsc blocks present in the catalog
+ * @dsc_peers:		per dsc, dsc blocks that can be paired with it
+ * @dsc_422:		dsc blocks supporting native 422/420
+ * @dsc_even:		dsc blocks with an even id, routable to even pingpongs
+ */
+struct sde_rm_graph {
+	unsigned long lm;
+	unsigned long lm_peers[LM_MAX];
+	unsigned long lm_dspp;
+	unsigned long lm_ds;
+	unsigned long lm_pp_split;
+	unsigned long lm_virtual;
+	unsigned long lm_primary_pref;
+	unsigned long lm_secondary_pref;
+	unsigned long lm_cwb_pref;
+	u32 lm_cwb_mask[LM_MAX];
+	u8 lm_pp[LM_MAX];
+
+	unsigned long dspp_lms[DSPP_MAX];
+	unsigned long ds_lms[DS_MAX];
+	unsigned long pp_lms[PINGPONG_MAX];
+	unsigned long pp_slave;
+
+	unsigned long ctl;
+	unsigned long ctl_split;
+	unsigned long ctl_ppsplit;
+	unsigned long ctl_primary_pref;
+	unsigned long ctl_secondary_pref;
+
+	unsigned long dsc;
+	unsigned long dsc_peers[DSC_MAX];
+	unsigned long dsc_422;
+	unsigned long dsc_even;
+};
+
+/**
+ * struct sde_rm_graph_req - what a reservation asks from the graph
+ * @num_lm:		number of layer mixers
+ * @num_ctl:		number of ctl paths
+ * @num_dsc:		number of dsc encoders
+ * @dspp:		mixers need a dspp
+ * @ds:			mixers need a dest scaler
+ * @cwb:		mixers are for concurrent writeback
+ * @ppsplit:		topology is pp split
+ * @split_display:	ctl paths need split display support
+ * @native_422_420:	dsc needs native 422/420 support
+ * @primary:		display is the primary display
+ * @secondary:		display is the secondary display
+ * @conn_lm_mask:	mixers used by the cwb source connector
+ * @lm_ids:		mixer ids to use in order, NULL to pick any
+ * @ctl_ids:		ctl ids to use in order, NULL to pick any
+ * @dsc_ids:		dsc ids to use in order, NULL to pick any
+ */
+struct sde_rm_graph_req {
+	u32 num_lm;
+	u32 num_ctl;
+	u32 num_dsc;
+	bool dspp;
+	bool ds;
+	bool cwb;
+	bool ppsplit;
+	bool split_display;
+	bool native_422_420;
+	bool primary;
+	bool secondary;
+	u32 conn_lm_mask;
+	const u8 *lm_ids;
+	const u8 *ctl_ids;
+	const u8 *dsc_ids;
+};
+
+/**
+ * sde_rm_graph_init - build the compatibility graph from the catalog
+ * @graph: graph to fill in
+ * @cat: hardware catalog
+ * @Return: 0 on success, -EINVAL if a block id does not fit in a mask
+ */
+int sde_rm_graph_init(struct sde_rm_graph *graph,
+		const struct sde_mdss_cfg *cat);
+
+/**
+ * sde_rm_graph_pick_lms - pick layer mixers for a reservation
+ * @graph: compatibility graph
+ * @req: reservation requirements
+ * @busy: per block type mask of the blocks held by other displays
+ * @lm_ids: output, ids of the picked mixers in pick order
+ * @Return: number of mixers picked, -ENAVAIL if the request can't be met
+ */
+int sde_rm_graph_pick_lms(const struct sde_rm_graph *graph,
+		const struct sde_rm_graph_req *req,
+		const unsigned long *busy, u8 *lm_ids);
+
+/**
+ * sde_rm_graph_pick_pp_slave - pick a pingpong slave for pp split
+ * @graph: compatibility graph
+ * @busy: per block type mask of the blocks held by other displays
+ * @Return: pingpong id, -ENAVAIL if none is free
+ */
+int sde_rm_graph_pick_pp_slave(const struct sde_rm_graph *graph,
+		const unsigned long *busy);
+
+/**
+ * sde_rm_graph_pick_ctls - pick ctl paths for a reservation
+ * @graph: compatibility graph
+ * @req: reservation requirements
+ * @busy: per block type mask of the blocks held by other displays
+ * @ctl_ids: output, ids of the picked ctl paths in pick order
+ * @Return: number of ctl paths picked, -ENAVAIL if the request can't be met
+ */
+int sde_rm_graph_pick_ctls(const struct sde_rm_graph *graph,
+		const struct sde_rm_graph_req *req,
+		const unsigned long *busy, u8 *ctl_ids);
+
+/**
+ * sde_rm_graph_pick_dscs - pick dsc encoders for a reservation
+ * @graph: compatibility graph
+ * @req: reservation requirements
+ * @busy: per block type mask of the blocks held by other displays
+ * @pp_ids: pingpongs of the reservation in ascending id order
+ * @num_pp: number of entries in pp_ids
+ * @dsc_ids: output, ids of the picked dsc encoders in pick order
+ * @Return: number of dsc encoders picked, -ENAVAIL if the request can't
+ *	be met
+ */
+int sde_rm_graph_pick_dscs(const struct sde_rm_graph *graph,
+		const struct sde_rm_graph_req *req,
+		const unsigned long *busy, const u8 *pp_ids, u32 num_pp,
+		u8 *dsc_ids);
+
+#endif /* _SDE_RM_GRAPH_H */
@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#include <kunit/test.h>
+#include <linux/slab.h>
+
+#include "sde_rm.h"
+#include "sde_rm_graph.h"
+#include "sde_kunit.h"
+
+/*
+ * Six mixers paired 0-1, 2-3 and 4-5, each hardwired to the pingpong of the
+ * same index and the first four to a dspp. PINGPONG_0 supports pp split,
+ * PINGPONG_S0 is the split slave, CTL_0 and CTL_1 support split display and
+ * pp split, CTL_2 pp split only. Six dsc blocks paired the same way as the
+ * mixers, the first four supporting native 422/420.
+ */
+static struct sde_mdss_cfg *sde_rm_graph_test_catalog(struct kunit *test)
+{
+	struct sde_mdss_cfg *cat;
+	int i;
+
+	cat = kunit_kzalloc(test, sizeof(*cat), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, cat);
+
+	cat->mixer_count = 6;
+	for (i = 0; i < cat->mixer_count; i++) {
+		struct sde_lm_cfg *lm = &cat->mixer[i];
+
+		lm->id = LM_0 + i;
+		lm->pingpong = PINGPONG_0 + i;
+		lm->dspp = (i < 4) ? DSPP_0 + i : DSPP_MAX;
+		lm->ds = DS_MAX;
+		lm->lm_pair_mask = BIT((i % 2) ? lm->id - 1 : lm->id + 1);
+	}
+
+	cat->dspp_count = 4;
+	for (i = 0; i < cat->dspp_count; i++)
+		cat->dspp[i].id = DSPP_0 + i;
+
+	cat->pingpong_count = 7;
+	for (i = 0; i < 6; i++)
+		cat->pingpong[i].id = PINGPONG_0 + i;
+	cat->pingpong[0].features = BIT(SDE_PINGPONG_SPLIT);
+	cat->pingpong[6].id = PINGPONG_S0;
+	cat->pingpong[6].features = BIT(SDE_PINGPONG_SLAVE);
+
+	cat->ctl_count = 6;
+	for (i = 0; i < cat->ctl_count; i++)
+		cat->ctl[i].id = CTL_0 + i;
+	cat->ctl[0].features = BIT(SDE_CTL_SPLIT_DISPLAY) |
+			BIT(SDE_CTL_PINGPONG_SPLIT);
+	cat->ctl[1].features = cat->ctl[0].features;
+	cat->ctl[2].features = BIT(SDE_CTL_PINGPONG_SPLIT);
+
+	cat->dsc_count = 6;
+	for (i = 0; i < cat->dsc_count; i++) {
+		struct sde_dsc_cfg *dsc = &cat->dsc[i];
+
+		dsc->id = DSC_0 + i;
+		set_bit((i % 2) ? dsc->id - 1 : dsc->id + 1,
+				dsc->dsc_pair_mask);
+		if (i < 4)
+			dsc->features = BIT(SDE_DSC_NATIVE_422_EN);
+	}
+
+	return cat;
+}
+
+static void sde_rm_graph_test_req(const struct sde_rm_topology_def *top,
+		struct sde_rm_graph_req *req)
+{
+	memset(req, 0, sizeof(*req));
+	req->num_lm = top->num_lm;
+	req->num_ctl = top->num_ctl;
+	req->num_dsc = top->num_comp_enc;
+	req->ppsplit = top->top_name == SDE_RM_TOPOLOGY_PPSPLIT;
+	req->split_display = top->needs_split_display;
+}
+
+static void sde_rm_graph_test_table(struct kunit *test,
+		const struct sde_rm_graph *graph,
+		const struct sde_rm_topology_def *table)
+{
+	unsigned long busy[SDE_HW_BLK_MAX] = { 0 };
+	unsigned long pp_mask;
+	u8 lm_ids[LM_MAX], ctl_ids[CTL_MAX], dsc_ids[DSC_MAX];
+	u8 pp_ids[PINGPONG_MAX];
+	struct sde_rm_graph_req req;
+	int t, i, id, num_pp;
+
+	for (t = 0; t < SDE_RM_TOPOLOGY_MAX; t++) {
+		const struct sde_rm_topology_def *top = &table[t];
+
+		if (top->top_name == SDE_RM_TOPOLOGY_NONE || !top->num_lm)
+			continue;
+
+		sde_rm_graph_test_req(top, &req);
+
+		KUNIT_ASSERT_EQ_MSG(test, top->num_lm,
+			sde_rm_graph_pick_lms(graph, &req, busy, lm_ids),
+			"topology %d", top->top_name);
+
+		/* every second mixer is the peer of the one before it */
+		pp_mask = 0;
+		for (i = 0; i < top->num_lm; i++) {
+			if (i % 2)
+				KUNIT_EXPECT_TRUE_MSG(test,
+					test_bit(lm_ids[i],
+						&graph->lm_peers[lm_ids[i - 1]]),
+					"topology %d lm %d", top->top_name,
+					lm_ids[i]);
+			__set_bit(graph->lm_pp[lm_ids[i]], &pp_mask);
+		}
+		KUNIT_EXPECT_EQ(test, top->num_lm, (int)hweight_long(pp_mask));
+
+		KUNIT_EXPECT_EQ_MSG(test, top->num_ctl,
+			sde_rm_graph_pick_ctls(graph, &req, busy, ctl_ids),
+			"topology %d", top->top_name);
+
+		if (req.ppsplit)
+			KUNIT_EXPECT_EQ(test, PINGPONG_S0,
+				sde_rm_graph_pick_pp_slave(graph, busy));
+
+		if (top->comp_type != MSM_DISPLAY_COMPRESSION_DSC)
+			continue;
+
+		num_pp = 0;
+		for_each_set_bit(id, &pp_mask, PINGPONG_MAX)
+			pp_ids[num_pp++] = id;
+
+		KUNIT_ASSERT_EQ_MSG(test, top->num_comp_enc,
+			sde_rm_graph_pick_dscs(graph, &req, busy, pp_ids,
+				num_pp, dsc_ids),
+			"topology %d", top->top_name);
+
+		/* dsc blocks are routed to pingpongs of the same parity */
+		for (i = 0; i < top->num_comp_enc; i++)
+			KUNIT_EXPECT_EQ_MSG(test, pp_ids[i] % 2, dsc_ids[i] % 2,
+				"topology %d dsc %d", top->top_name,
+				dsc_ids[i]);
+	}
+}
+
+static void sde_rm_graph_test_topologies(struct kunit *test)
+{
+	struct sde_mdss_cfg *cat = sde_rm_graph_test_catalog(test);
+	struct sde_rm_graph graph;
+
+	KUNIT_ASSERT_EQ(test, 0, sde_rm_graph_init(&graph, cat));
+
+	sde_rm_graph_test_table(test, &graph,
+			sde_rm_get_topology_table(SDE_CTL_CFG_VERSION_1_0_0));
+	sde_rm_graph_test_table(test, &graph, sde_rm_get_topology_table(0));
+}
+
+static void sde_rm_graph_test_busy(struct kunit *test)
+{
+	struct sde_mdss_cfg *cat = sde_rm_graph_test_catalog(test);
+	unsigned long busy[SDE_HW_BLK_MAX] = { 0 };
+	struct sde_rm_graph_req req = { .num_lm = 2, .dspp = true };
+	struct sde_rm_graph graph;
+	u8 lm_ids[LM_MAX];
+
+	KUNIT_ASSERT_EQ(test, 0, sde_rm_graph_init(&graph, cat));
+
+	/* LM_0 loses its dspp to another display, so does its pair */
+	__set_bit(DSPP_0, &busy[SDE_HW_BLK_DSPP]);
+	KUNIT_ASSERT_EQ(test, 2,
+			sde_rm_graph_pick_lms(&graph, &req, busy, lm_ids));
+	KUNIT_EXPECT_EQ(test, LM_2, (int)lm_ids[0]);
+	KUNIT_EXPECT_EQ(test, LM_3, (int)lm_ids[1]);
+
+	/* the remaining mixers with a dspp lose their pingpong */
+	__set_bit(PINGPONG_3, &busy[SDE_HW_BLK_PINGPONG]);
+	KUNIT_EXPECT_EQ(test, -ENAVAIL,
+			sde_rm_graph_pick_lms(&graph, &req, busy, lm_ids));
+
+	/* mixers without a dspp are still available */
+	req.dspp = false;
+	KUNIT_ASSERT_EQ(test, 2,
+			sde_rm_graph_pick_lms(&graph, &req, busy, lm_ids));
+	KUNIT_EXPECT_EQ(test, LM_4, (int)lm_ids[0]);
+	KUNIT_EXPECT_EQ(test, LM_5, (int)lm_ids[1]);
+
+	busy[SDE_HW_BLK_LM] = graph.lm;
+	KUNIT_EXPECT_EQ(test, -ENAVAIL,
+			sde_rm_graph_pick_lms(&graph, &req, busy, lm_ids));
+}
+
+static void sde_rm_graph_test_display_pref(struct kunit *test)
+{
+	struct sde_mdss_cfg *cat = sde_rm_graph_test_catalog(test);
+	unsigned long busy[SDE_HW_BLK_MAX] = { 0 };
+	struct sde_rm_graph_req req = { .num_lm = 2, .num_ctl = 1 };
+	struct sde_rm_graph graph;
+	u8 lm_ids[LM_MAX], ctl_ids[CTL_MAX];
+
+	cat->mixer[4].features = BIT(SDE_DISP_PRIMARY_PREF);
+	cat->mixer[5].features = BIT(SDE_DISP_PRIMARY_PREF);
+	cat->ctl[5].features = BIT(SDE_CTL_PRIMARY_PREF);
+	KUNIT_ASSERT_EQ(test, 0, sde_rm_graph_init(&graph, cat));
+
+	/* other displays never get the mixers preferred for the primary */
+	busy[SDE_HW_BLK_LM] = BIT(LM_0) | BIT(LM_1) | BIT(LM_2) | BIT(LM_3);
+	KUNIT_EXPECT_EQ(test, -ENAVAIL,
+			sde_rm_graph_pick_lms(&graph, &req, busy, lm_ids));
+	KUNIT_ASSERT_EQ(test, 1,
+			sde_rm_graph_pick_ctls(&graph, &req, busy, ctl_ids));
+	KUNIT_EXPECT_NE(test, CTL_5, (int)ctl_ids[0]);
+
+	/* and the primary display only gets the preferred ctl */
+	req.primary = true;
+	KUNIT_ASSERT_EQ(test, 2,
+			sde_rm_graph_pick_lms(&graph, &req, busy, lm_ids));
+	KUNIT_EXPECT_EQ(test, LM_4, (int)lm_ids[0]);
+	KUNIT_EXPECT_EQ(test, LM_5, (int)lm_ids[1]);
+	KUNIT_ASSERT_EQ(test, 1,
+			sde_rm_graph_pick_ctls(&graph, &req, busy, ctl_ids));
+	KUNIT_EXPECT_EQ(test, CTL_5, (int)ctl_ids[0]);
+}
+
+static struct kunit_case sde_rm_graph_test_cases[] = {
+	KUNIT_CASE(sde_rm_graph_test_topologies),
+	KUNIT_CASE(sde_rm_graph_test_busy),
+	KUNIT_CASE(sde_rm_graph_test_display_pref),
+	{}
+};
+
+struct kunit_suite sde_rm_graph_test_suite = {
+	.name = "sde_rm_graph",
+	.test_cases = sde_rm_graph_test_cases,
+};
@@ -113,6 +113,23 @@ TRACE_EVENT(sde_encoder_underrun,
 		__entry->underrun_cnt)
 );
 
+TRACE_EVENT(sde_irq_dispatch,
+	TP_PROTO(u32 reg_idx, u32 irq_status, u64 duration_ns),
+	TP_ARGS(reg_idx, irq_status, duration_ns),
+	TP_STRUCT__entry(
+			__field(u32, reg_idx)
+			__field(u32, irq_status)
+			__field(u64, duration_ns)
+	),
+	TP_fast_assign(
+			__entry->reg_idx = reg_idx;
+			__entry->irq_status = irq_status;
+			__entry->duration_ns = duration_ns;
+	),
+	TP_printk("reg:%d status:0x%x duration_ns:%llu", __entry->reg_idx,
+			__entry->irq_status, __entry->duration_ns)
+);
+
 TRACE_EVENT(tracing_mark_write,
 	TP_PROTO(char trace_type, const struct task_struct *task,
 		const char *name, int value),
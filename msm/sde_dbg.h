@@ -90,12 +90,21 @@ enum sde_dbg_dump_context {
  */
 #define SDE_EVTLOG_PRINT_ENTRY	256
 
+/*
+ * evtlog keeps its entries in this number of rings, one per cpu. Cpus past
+ * the number of rings share them.
+ */
+#define SDE_EVTLOG_RINGS	8
+
+/* entries of each ring, a power of two */
+#define SDE_EVTLOG_RING_ENTRY	1024
+
 /*
  * evtlog keeps this number of entries in memory for debug purpose. This
  * number must be greater than print entry to prevent out of bound evtlog
  * entry array access.
  */
-#define SDE_EVTLOG_ENTRY	(SDE_EVTLOG_PRINT_ENTRY * 32)
+#define SDE_EVTLOG_ENTRY	(SDE_EVTLOG_RING_ENTRY * SDE_EVTLOG_RINGS)
 #define SDE_EVTLOG_MAX_DATA 15
 #define SDE_EVTLOG_BUF_MAX 512
 #define SDE_EVTLOG_BUF_ALIGN 32
@@ -114,22 +123,56 @@ struct sde_dbg_evtlog_log {
 	u32 data_cnt;
 	int pid;
 	u8 cpu;
+	u32 seq;
+};
+
+/**
+ * struct sde_dbg_evtlog_ring - event log entries of one cpu
+ * @logs: ring of SDE_EVTLOG_RING_ENTRY log entries, a slice of the evtlog
+ *	logs
+ * @curr: number of entries ever claimed, a writer claims a slot by
+ *	incrementing it
+ * @next: sequence of the next entry to be output during evtlog dumps
+ * @last_dump: sequence one past the last entry to be output during dumps
+ * @first: oldest sequence left to dump, used while skipping entries
+ */
+struct sde_dbg_evtlog_ring {
+	struct sde_dbg_evtlog_log *logs;
+	atomic_t curr;
+	u32 next;
+	u32 last_dump;
+	u32 first;
+} ____cacheline_aligned_in_smp;
+
+/**
+ * struct sde_dbg_evtlog_site - cached filter decision of an evtlog call site
+ * @cache: filter generation the decision was taken at, shifted left by one,
+ *	ORed with one if the call site is filtered out
+ */
+struct sde_dbg_evtlog_site {
+	u32 cache;
 };
 
 /**
- * @last_dump: Index of last entry to be output during evtlog dumps
+ * @logs: log entries, split into SDE_EVTLOG_RINGS rings. This is the start
+ *	of the "evt_log" minidump region as before, but the entries are no
+ *	longer in logging order and the dump markers that used to follow them
+ *	are gone: order the valid entries by time. An entry is valid once its
+ *	seq is congruent to its slot modulo SDE_EVTLOG_RING_ENTRY.
+ * @rings: per-cpu rings of log entries, written without locks
+ * @prev_time: timestamp of the last entry output during evtlog dumps
+ * @spin_lock: protects the filter list and the dump markers
  * @filter_list: Linked list of currently active filter strings
+ * @filter_gen: generation of filter_list, bumped on every change
  */
 struct sde_dbg_evtlog {
 	struct sde_dbg_evtlog_log logs[SDE_EVTLOG_ENTRY];
-	u32 first;
-	u32 last;
-	u32 last_dump;
-	u32 curr;
-	u32 next;
+	struct sde_dbg_evtlog_ring rings[SDE_EVTLOG_RINGS];
+	s64 prev_time;
 	u32 enable;
 	spinlock_t spin_lock;
 	struct list_head filter_list;
+	atomic_t filter_gen;
 };
 
 extern struct sde_dbg_evtlog *sde_dbg_base_evtlog;
@@ -171,44 +214,48 @@ extern struct sde_dbg_reglog *sde_dbg_base_reglog;
  */
 #define SDE_REG_LOG(blk_id, val, addr) sde_reglog_log(blk_id, val, addr)
 
+/**
+ * _SDE_EVT32 - Write a list of 32bit values to the event log
+ * Each call site keeps its own filter decision, so the filter strings are
+ * only matched against __func__ again after the filter list changes.
+ * @flag: log area filter flag
+ * ... - variable arguments
+ */
+#define _SDE_EVT32(flag, ...) do { \
+		static struct sde_dbg_evtlog_site __sde_evt_site; \
+		sde_evtlog_log(sde_dbg_base_evtlog, &__sde_evt_site, \
+				__func__, __LINE__, flag, ##__VA_ARGS__, \
+				SDE_EVTLOG_DATA_LIMITER); \
+	} while (0)
+
 /**
  * SDE_EVT32 - Write a list of 32bit values to the event log, default area
  * ... - variable arguments
  */
-#define SDE_EVT32(...) sde_evtlog_log(sde_dbg_base_evtlog, __func__, \
-		__LINE__, SDE_EVTLOG_ALWAYS, ##__VA_ARGS__, \
-		SDE_EVTLOG_DATA_LIMITER)
+#define SDE_EVT32(...) _SDE_EVT32(SDE_EVTLOG_ALWAYS, ##__VA_ARGS__)
 
 /**
  * SDE_EVT32_VERBOSE - Write a list of 32bit values for verbose event logging
  * ... - variable arguments
  */
-#define SDE_EVT32_VERBOSE(...) sde_evtlog_log(sde_dbg_base_evtlog, __func__, \
-		__LINE__, SDE_EVTLOG_VERBOSE, ##__VA_ARGS__, \
-		SDE_EVTLOG_DATA_LIMITER)
+#define SDE_EVT32_VERBOSE(...) _SDE_EVT32(SDE_EVTLOG_VERBOSE, ##__VA_ARGS__)
 
 /**
  * SDE_EVT32_IRQ - Write a list of 32bit values to the event log, IRQ area
  * ... - variable arguments
  */
-#define SDE_EVT32_IRQ(...) sde_evtlog_log(sde_dbg_base_evtlog, __func__, \
-		__LINE__, SDE_EVTLOG_IRQ, ##__VA_ARGS__, \
-		SDE_EVTLOG_DATA_LIMITER)
+#define SDE_EVT32_IRQ(...) _SDE_EVT32(SDE_EVTLOG_IRQ, ##__VA_ARGS__)
 
 /**
  * SDE_EVT32_EXTERNAL - Write a list of 32bit values for external display events
  * ... - variable arguments
  */
-#define SDE_EVT32_EXTERNAL(...) sde_evtlog_log(sde_dbg_base_evtlog, __func__, \
-		__LINE__, SDE_EVTLOG_EXTERNAL, ##__VA_ARGS__, \
-		SDE_EVTLOG_DATA_LIMITER)
+#define SDE_EVT32_EXTERNAL(...) _SDE_EVT32(SDE_EVTLOG_EXTERNAL, ##__VA_ARGS__)
 /**
  * SDE_EVT32_REGWRITE - Write a list of 32bit values for register writes logging
  * ... - variable arguments
  */
-#define SDE_EVT32_REGWRITE(...) sde_evtlog_log(sde_dbg_base_evtlog, __func__, \
-		__LINE__, SDE_EVTLOG_REGWRITE, ##__VA_ARGS__, \
-		SDE_EVTLOG_DATA_LIMITER)
+#define SDE_EVT32_REGWRITE(...) _SDE_EVT32(SDE_EVTLOG_REGWRITE, ##__VA_ARGS__)
 
 /**
  * SDE_DBG_DUMP - trigger dumping of all sde_dbg facilities
@@ -283,12 +330,14 @@ void sde_reglog_destroy(struct sde_dbg_reglog *reglog);
  *	log collection may be enabled/disabled entirely via debugfs
  *	log area collection may be filtered by user provided flags via debugfs.
  * @evtlog:	pointer to evtlog
+ * @site:	cached filter decision of the call site, may be NULL
  * @name:	function name of call site
  * @line:	line number of call site
  * @flag:	log area filter flag checked against user's debugfs request
  * Returns:	none
  */
-void sde_evtlog_log(struct sde_dbg_evtlog *evtlog, const char *name, int line,
+void sde_evtlog_log(struct sde_dbg_evtlog *evtlog,
+		struct sde_dbg_evtlog_site *site, const char *name, int line,
 		int flag, ...);
 
 /**
@@ -329,6 +378,13 @@ ssize_t sde_evtlog_dump_to_buffer(struct sde_dbg_evtlog *evtlog,
 		char *evtlog_buf, ssize_t evtlog_buf_size,
 		bool update_last_entry, bool full_dump);
 
+/**
+ * sde_evtlog_dump_rewind - restart dumps from the oldest entry in memory
+ * @evtlog:		pointer to evtlog
+ * Returns:		none
+ */
+void sde_evtlog_dump_rewind(struct sde_dbg_evtlog *evtlog);
+
 /**
  * sde_dbg_init_dbg_buses - initialize debug bus dumping support for the chipset
  * @hwversion:		Chipset revision
@@ -8,6 +8,7 @@
 #include <linux/delay.h>
 #include <linux/spinlock.h>
 #include <linux/ktime.h>
+#include <linux/log2.h>
 #include <linux/debugfs.h>
 #include <linux/uaccess.h>
 #include <linux/dma-buf.h>
@@ -18,6 +19,7 @@
 #include "sde_trace.h"
 
 #define SDE_EVTLOG_FILTER_STRSIZE	64
+#define SDE_EVTLOG_RING_MASK		(SDE_EVTLOG_RING_ENTRY - 1)
 
 struct sde_evtlog_filter {
 	struct list_head list;
@@ -55,32 +57,79 @@ bool sde_evtlog_is_enabled(struct sde_dbg_evtlog *evtlog, u32 flag)
 	return evtlog && (evtlog->enable & flag);
 }
 
-void sde_evtlog_log(struct sde_dbg_evtlog *evtlog, const char *name, int line,
-		int flag, ...)
+/* returns true if events of the call site are filtered out */
+static bool _sde_evtlog_is_filtered(struct sde_dbg_evtlog *evtlog,
+		struct sde_dbg_evtlog_site *site, const char *name)
 {
 	unsigned long flags;
+	bool filtered;
+	u32 gen, cache;
+
+	if (!site) {
+		if (list_empty(&evtlog->filter_list))
+			return false;
+
+		spin_lock_irqsave(&evtlog->spin_lock, flags);
+		filtered = _sde_evtlog_is_filtered_no_lock(evtlog, name);
+		spin_unlock_irqrestore(&evtlog->spin_lock, flags);
+		return filtered;
+	}
+
+	gen = (u32)atomic_read(&evtlog->filter_gen);
+	cache = READ_ONCE(site->cache);
+	if ((cache >> 1) == (gen & (U32_MAX >> 1)))
+		return cache & 1;
+
+	/* filter list changed since the last event of this call site */
+	spin_lock_irqsave(&evtlog->spin_lock, flags);
+	gen = (u32)atomic_read(&evtlog->filter_gen);
+	filtered = _sde_evtlog_is_filtered_no_lock(evtlog, name);
+	spin_unlock_irqrestore(&evtlog->spin_lock, flags);
+
+	WRITE_ONCE(site->cache, (gen << 1) | filtered);
+
+	return filtered;
+}
+
+void sde_evtlog_log(struct sde_dbg_evtlog *evtlog,
+		struct sde_dbg_evtlog_site *site, const char *name, int line,
+		int flag, ...)
+{
 	int i, val = 0;
 	va_list args;
+	struct sde_dbg_evtlog_ring *ring;
 	struct sde_dbg_evtlog_log *log;
+	u32 cpu, seq;
 
-	if (!evtlog)
+	if (!evtlog || !name)
 		return;
 
 	if (!sde_evtlog_is_enabled(evtlog, flag))
 		return;
 
-	spin_lock_irqsave(&evtlog->spin_lock, flags);
+	if (_sde_evtlog_is_filtered(evtlog, site, name))
+		return;
 
-	if (_sde_evtlog_is_filtered_no_lock(evtlog, name))
-		goto exit;
+	/*
+	 * Claim a slot in this cpu's ring. Migrating after reading the cpu id,
+	 * or sharing the ring with another cpu, is harmless since claiming the
+	 * slot is a single atomic operation.
+	 */
+	cpu = raw_smp_processor_id();
+	ring = &evtlog->rings[cpu % SDE_EVTLOG_RINGS];
+	seq = (u32)atomic_inc_return(&ring->curr) - 1;
+	log = &ring->logs[seq & SDE_EVTLOG_RING_MASK];
+
+	/* ~seq never matches a sequence of this slot, readers skip it */
+	WRITE_ONCE(log->seq, ~seq);
+	smp_wmb();
 
-	log = &evtlog->logs[evtlog->curr];
 	log->time = local_clock();
 	log->name = name;
 	log->line = line;
 	log->data_cnt = 0;
 	log->pid = current->pid;
-	log->cpu = raw_smp_processor_id();
+	log->cpu = cpu;
 
 	va_start(args, flag);
 	for (i = 0; i < SDE_EVTLOG_MAX_DATA; i++) {
@@ -93,12 +142,11 @@ void sde_evtlog_log(struct sde_dbg_evtlog *evtlog, const char *name, int line,
 	}
 	va_end(args);
 	log->data_cnt = i;
-	evtlog->curr = (evtlog->curr + 1) % SDE_EVTLOG_ENTRY;
-	evtlog->last++;
+
+	smp_wmb();
+	WRITE_ONCE(log->seq, seq);
 
 	trace_sde_evtlog(name, line, log->data_cnt, log->data);
-exit:
-	spin_unlock_irqrestore(&evtlog->spin_lock, flags);
 }
 
 void sde_reglog_log(u8 blk_id, u32 val, u32 addr)
@@ -121,48 +169,135 @@ void sde_reglog_log(u8 blk_id, u32 val, u32 addr)
 	reglog->last++;
 }
 
+/* returns the ring holding the oldest entry which is not dumped yet */
+static struct sde_dbg_evtlog_ring *_sde_evtlog_dump_next_ring(
+		struct sde_dbg_evtlog *evtlog)
+{
+	struct sde_dbg_evtlog_ring *ring, *oldest = NULL;
+	s64 oldest_time = 0;
+	s64 time;
+	u32 i;
+
+	for (i = 0; i < SDE_EVTLOG_RINGS; i++) {
+		ring = &evtlog->rings[i];
+		if (ring->next == ring->last_dump)
+			continue;
+
+		time = READ_ONCE(ring->logs[ring->next &
+				SDE_EVTLOG_RING_MASK].time);
+		if (!oldest || time < oldest_time) {
+			oldest = ring;
+			oldest_time = time;
+		}
+	}
+
+	return oldest;
+}
+
+/*
+ * Keeps the newest max_entries entries across all rings, picking them from
+ * the newest end so the cost does not depend on the number skipped.
+ */
+static void _sde_evtlog_dump_skip(struct sde_dbg_evtlog *evtlog,
+		u32 max_entries)
+{
+	struct sde_dbg_evtlog_ring *ring, *newest;
+	s64 time, newest_time;
+	u32 i, keep;
+
+	for (i = 0; i < SDE_EVTLOG_RINGS; i++) {
+		ring = &evtlog->rings[i];
+		ring->first = ring->next;
+		ring->next = ring->last_dump;
+	}
+
+	for (keep = 0; keep < max_entries; keep++) {
+		newest = NULL;
+		newest_time = 0;
+		for (i = 0; i < SDE_EVTLOG_RINGS; i++) {
+			ring = &evtlog->rings[i];
+			if (ring->next == ring->first)
+				continue;
+
+			time = READ_ONCE(ring->logs[(ring->next - 1) &
+					SDE_EVTLOG_RING_MASK].time);
+			if (!newest || time > newest_time) {
+				newest = ring;
+				newest_time = time;
+			}
+		}
+		if (!newest)
+			break;
+		newest->next--;
+	}
+}
+
 /* always dump the last entries which are not dumped yet */
 static bool _sde_evtlog_dump_calc_range(struct sde_dbg_evtlog *evtlog,
 		bool update_last_entry, bool full_dump)
 {
 	int max_entries = full_dump ? SDE_EVTLOG_ENTRY : SDE_EVTLOG_PRINT_ENTRY;
+	struct sde_dbg_evtlog_ring *ring;
+	u32 i, total = 0;
 
 	if (!evtlog)
 		return false;
 
-	evtlog->first = evtlog->next;
-
-	if (update_last_entry)
-		evtlog->last_dump = evtlog->last;
+	for (i = 0; i < SDE_EVTLOG_RINGS; i++) {
+		ring = &evtlog->rings[i];
+		if (update_last_entry)
+			ring->last_dump = atomic_read(&ring->curr);
 
-	if (evtlog->last_dump == evtlog->first)
-		return false;
+		/* older entries have been overwritten by the writers */
+		if (ring->last_dump - ring->next > SDE_EVTLOG_RING_ENTRY)
+			ring->next = ring->last_dump - SDE_EVTLOG_RING_ENTRY;
 
-	if (evtlog->last_dump < evtlog->first) {
-		evtlog->first %= SDE_EVTLOG_ENTRY;
-		if (evtlog->last_dump < evtlog->first)
-			evtlog->last_dump += SDE_EVTLOG_ENTRY;
+		total += ring->last_dump - ring->next;
 	}
 
-	if ((evtlog->last_dump - evtlog->first) > max_entries) {
-		pr_info("evtlog skipping %d entries, last=%d\n",
-			evtlog->last_dump - evtlog->first -
-			max_entries, evtlog->last_dump - 1);
-		evtlog->first = evtlog->last_dump - max_entries;
+	if (!total)
+		return false;
+
+	/* drop the oldest entries across all rings beyond the print limit */
+	if (total > max_entries) {
+		pr_info("evtlog skipping %d entries\n", total - max_entries);
+		_sde_evtlog_dump_skip(evtlog, max_entries);
 	}
-	evtlog->next = evtlog->first + 1;
 
 	return true;
 }
 
+/*
+ * Copies out an entry, returns false if a writer claimed its slot again
+ * before or while it was read.
+ */
+static bool _sde_evtlog_dump_read(struct sde_dbg_evtlog_ring *ring, u32 seq,
+		struct sde_dbg_evtlog_log *log)
+{
+	struct sde_dbg_evtlog_log *entry =
+			&ring->logs[seq & SDE_EVTLOG_RING_MASK];
+
+	if (READ_ONCE(entry->seq) != seq)
+		return false;
+
+	smp_rmb();
+	memcpy(log, entry, sizeof(*log));
+	smp_rmb();
+
+	return READ_ONCE(entry->seq) == seq &&
+			log->data_cnt <= SDE_EVTLOG_MAX_DATA;
+}
+
 ssize_t sde_evtlog_dump_to_buffer(struct sde_dbg_evtlog *evtlog,
 		char *evtlog_buf, ssize_t evtlog_buf_size,
 		bool update_last_entry, bool full_dump)
 {
 	int i;
 	ssize_t off = 0;
-	struct sde_dbg_evtlog_log *log, *prev_log;
+	struct sde_dbg_evtlog_ring *ring;
+	struct sde_dbg_evtlog_log entry, *log = &entry;
 	unsigned long flags;
+	u32 seq;
 
 	if (!evtlog || !evtlog_buf)
 		return 0;
@@ -173,9 +308,14 @@ ssize_t sde_evtlog_dump_to_buffer(struct sde_dbg_evtlog *evtlog,
 	if (!_sde_evtlog_dump_calc_range(evtlog, update_last_entry, full_dump))
 		goto exit;
 
-	log = &evtlog->logs[evtlog->first % SDE_EVTLOG_ENTRY];
+	/* merge the per-cpu rings in timestamp order, skip overwritten ones */
+	do {
+		ring = _sde_evtlog_dump_next_ring(evtlog);
+		if (!ring)
+			goto exit;
 
-	prev_log = &evtlog->logs[(evtlog->first - 1) % SDE_EVTLOG_ENTRY];
+		seq = ring->next++;
+	} while (!_sde_evtlog_dump_read(ring, seq, log));
 
 	off = snprintf((evtlog_buf + off), (evtlog_buf_size - off), "%s:%-4d",
 		log->name, log->line);
@@ -186,8 +326,9 @@ ssize_t sde_evtlog_dump_to_buffer(struct sde_dbg_evtlog *evtlog,
 	}
 
 	off += snprintf((evtlog_buf + off), (evtlog_buf_size - off),
-		"=>[%-8d:%-11llu:%9llu][%-4d]:[%-4d]:", evtlog->first,
-		log->time, (log->time - prev_log->time), log->pid, log->cpu);
+		"=>[%-8d:%-11llu:%9llu][%-4d]:[%-4d]:", seq,
+		log->time, (log->time - evtlog->prev_time), log->pid, log->cpu);
+	evtlog->prev_time = log->time;
 
 	for (i = 0; i < log->data_cnt; i++)
 		off += snprintf((evtlog_buf + off), (evtlog_buf_size - off),
@@ -200,6 +341,25 @@ exit:
 	return off;
 }
 
+void sde_evtlog_dump_rewind(struct sde_dbg_evtlog *evtlog)
+{
+	struct sde_dbg_evtlog_ring *ring;
+	unsigned long flags;
+	u32 i, curr;
+
+	if (!evtlog)
+		return;
+
+	spin_lock_irqsave(&evtlog->spin_lock, flags);
+	for (i = 0; i < SDE_EVTLOG_RINGS; i++) {
+		ring = &evtlog->rings[i];
+		curr = atomic_read(&ring->curr);
+		ring->next = curr - min_t(u32, curr, SDE_EVTLOG_RING_ENTRY);
+	}
+	evtlog->prev_time = 0;
+	spin_unlock_irqrestore(&evtlog->spin_lock, flags);
+}
+
 void sde_evtlog_dump_all(struct sde_dbg_evtlog *evtlog)
 {
 	char buf[SDE_EVTLOG_BUF_MAX];
@@ -218,20 +378,30 @@ void sde_evtlog_dump_all(struct sde_dbg_evtlog *evtlog)
 struct sde_dbg_evtlog *sde_evtlog_init(void)
 {
 	struct sde_dbg_evtlog *evtlog;
+	u32 i;
 
 	evtlog = kzalloc(sizeof(*evtlog), GFP_KERNEL);
 	if (!evtlog)
 		return ERR_PTR(-ENOMEM);
 
-	if (sde_mini_dump_add_region("evt_log", sizeof(*evtlog),
-			evtlog) < 0)
-		pr_err("minidump add region failed for evtlog\n");
-
 	spin_lock_init(&evtlog->spin_lock);
 	evtlog->enable = SDE_EVTLOG_DEFAULT_ENABLE;
 
 	INIT_LIST_HEAD(&evtlog->filter_list);
 
+	/* call sites start at generation 0, force their first evaluation */
+	atomic_set(&evtlog->filter_gen, 1);
+
+	for (i = 0; i < SDE_EVTLOG_RINGS; i++) {
+		evtlog->rings[i].logs =
+				&evtlog->logs[i * SDE_EVTLOG_RING_ENTRY];
+		atomic_set(&evtlog->rings[i].curr, 0);
+	}
+
+	if (sde_mini_dump_add_region("evt_log", sizeof(*evtlog),
+			evtlog) < 0)
+		pr_err("minidump add region failed for evtlog\n");
+
 	return evtlog;
 }
 
@@ -276,6 +446,14 @@ int sde_evtlog_get_filter(struct sde_dbg_evtlog *evtlog, int index,
 	return rc;
 }
 
+/* invalidates the cached decisions of all call sites, call with spin_lock */
+static void _sde_evtlog_filter_changed(struct sde_dbg_evtlog *evtlog)
+{
+	/* generation 0 is what unused call sites hold, skip it on wrap */
+	if (!(atomic_inc_return(&evtlog->filter_gen) & (U32_MAX >> 1)))
+		atomic_inc(&evtlog->filter_gen);
+}
+
 void sde_evtlog_set_filter(struct sde_dbg_evtlog *evtlog, char *filter)
 {
 	struct sde_evtlog_filter *filter_node, *tmp;
@@ -297,6 +475,7 @@ void sde_evtlog_set_filter(struct sde_dbg_evtlog *evtlog, char *filter)
 		list_del_init(&filter_node->list);
 		list_add_tail(&filter_node->list, &free_list);
 	}
+	_sde_evtlog_filter_changed(evtlog);
 	spin_unlock_irqrestore(&evtlog->spin_lock, flags);
 
 	/*
@@ -327,6 +506,7 @@ void sde_evtlog_set_filter(struct sde_dbg_evtlog *evtlog, char *filter)
 
 		spin_lock_irqsave(&evtlog->spin_lock, flags);
 		list_add_tail(&filter_node->list, &evtlog->filter_list);
+		_sde_evtlog_filter_changed(evtlog);
 		spin_unlock_irqrestore(&evtlog->spin_lock, flags);
 	}
 
@@ -350,6 +530,7 @@ void sde_evtlog_destroy(struct sde_dbg_evtlog *evtlog)
 		list_del(&filter_node->list);
 		kfree(filter_node);
 	}
+
 	kfree(evtlog);
 }
 
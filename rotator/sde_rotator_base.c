@@ -894,6 +894,7 @@ int sde_rotator_base_init(struct sde_rot_data_type **pmdata,
 
 	mdata->pdev = pdev;
 	sde_rot_res = mdata;
+	sde_mdp_format_init_hash();
 	mutex_init(&mdata->reg_bus_lock);
 	INIT_LIST_HEAD(&mdata->reg_bus_clist);
 
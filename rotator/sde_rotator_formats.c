@@ -7,6 +7,7 @@
 
 #include "sde_rotator_formats.h"
 #include "sde_rotator_util.h"
+#include "sde_format_hash.h"
 
 #define FMT_RGB_565(fmt, desc, frame_fmt, flag_arg, e0, e1, e2, isubwc)	\
 	{							\
@@ -779,38 +780,70 @@ static struct sde_mdp_format_params sde_mdp_format_map[] = {
 		SDE_MDP_COMPRESS_NONE),
 };
 
+/*
+ * Hash on the pixel format over both format maps. The rotator formats
+ * carry no modifier, the ubwc ones are distinct pixel formats. Lookups
+ * walk the maps until sde_mdp_format_init_hash() marked it ready.
+ */
+static struct sde_format_hash sde_mdp_format_hash;
+
+static struct sde_mdp_format_params *sde_mdp_format_entry(u32 idx)
+{
+	if (idx < ARRAY_SIZE(sde_mdp_format_map))
+		return &sde_mdp_format_map[idx];
+
+	return &sde_mdp_format_ubwc_map[idx -
+			ARRAY_SIZE(sde_mdp_format_map)].mdp_format;
+}
+
+/*
+ * sde_mdp_format_init_hash - build the format lookup hash
+ */
+void sde_mdp_format_init_hash(void)
+{
+	u32 count = ARRAY_SIZE(sde_mdp_format_map) +
+			ARRAY_SIZE(sde_mdp_format_ubwc_map);
+	struct sde_mdp_format_params *fmt;
+	u32 i;
+
+	BUILD_BUG_ON(ARRAY_SIZE(sde_mdp_format_map) +
+			ARRAY_SIZE(sde_mdp_format_ubwc_map) >=
+			SDE_FORMAT_HASH_SIZE);
+
+	if (sde_format_hash_is_ready(&sde_mdp_format_hash))
+		return;
+
+	/* the first entry of a duplicated format wins */
+	for (i = 0; i < count; i++) {
+		fmt = sde_mdp_format_entry(i);
+		sde_format_hash_add(&sde_mdp_format_hash, fmt->format, 0, fmt);
+	}
+
+	sde_format_hash_set_ready(&sde_mdp_format_hash);
+}
+
 /*
  * sde_get_format_params - return format parameter of the given format
  * @format: format to lookup
  */
 struct sde_mdp_format_params *sde_get_format_params(u32 format)
 {
-	struct sde_mdp_format_params *fmt = NULL;
-	int i;
-	bool fmt_found = false;
-
-	for (i = 0; i < ARRAY_SIZE(sde_mdp_format_map); i++) {
-		fmt = &sde_mdp_format_map[i];
-		if (format == fmt->format) {
-			fmt_found = true;
-			break;
-		}
+	struct sde_mdp_format_params *fmt;
+	u32 i;
+
+	if (sde_format_hash_is_ready(&sde_mdp_format_hash))
+		return (struct sde_mdp_format_params *)sde_format_hash_find(
+				&sde_mdp_format_hash, format, 0);
+
+	for (i = 0; i < ARRAY_SIZE(sde_mdp_format_map) +
+			ARRAY_SIZE(sde_mdp_format_ubwc_map); i++) {
+		fmt = sde_mdp_format_entry(i);
+		if (format == fmt->format)
+			return fmt;
 	}
 
-	if (!fmt_found) {
-		for (i = 0; i < ARRAY_SIZE(sde_mdp_format_ubwc_map); i++) {
-			fmt = &sde_mdp_format_ubwc_map[i].mdp_format;
-			if (format == fmt->format) {
-				fmt_found = true;
-				break;
-			}
-		}
-	}
 	/* If format not supported than return NULL */
-	if (!fmt_found)
-		fmt = NULL;
-
-	return fmt;
+	return NULL;
 }
 
 /*
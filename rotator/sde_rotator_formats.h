@@ -120,6 +120,8 @@ struct sde_mdp_format_params_ubwc {
 
 struct sde_mdp_format_params *sde_get_format_params(u32 format);
 
+void sde_mdp_format_init_hash(void);
+
 int sde_rot_get_ubwc_micro_dim(u32 format, u16 *w, u16 *h);
 
 int sde_rot_get_base_tilea5x_pixfmt(u32 src_pixfmt, u32 *dst_pixfmt);